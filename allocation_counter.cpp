@@ -0,0 +1,86 @@
+// Counting replacements for the global allocation functions; linked only
+// when SNAKE_COUNT_ALLOCATIONS is on.
+#include <cstdlib>
+#include <new>
+
+#include "allocation_counter.h"
+
+namespace {
+
+void* counted_allocation(std::size_t size) {
+	AllocationCounter::on_allocation();
+	if (void* memory = std::malloc(size ? size : 1)) {
+		return memory;
+	}
+	throw std::bad_alloc();
+}
+
+void* counted_aligned_allocation(std::size_t size, std::align_val_t alignment) {
+	AllocationCounter::on_allocation();
+	std::size_t align = static_cast<std::size_t>(alignment);
+	// aligned_alloc wants the size to be a multiple of the alignment
+	if (void* memory = std::aligned_alloc(align, (size + align - 1) / align * align)) {
+		return memory;
+	}
+	throw std::bad_alloc();
+}
+
+} // local namespace
+
+void* operator new(std::size_t size) {
+	return counted_allocation(size);
+}
+
+void* operator new[](std::size_t size) {
+	return counted_allocation(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+	AllocationCounter::on_allocation();
+	return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+	AllocationCounter::on_allocation();
+	return std::malloc(size ? size : 1);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+	return counted_aligned_allocation(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+	return counted_aligned_allocation(size, alignment);
+}
+
+void operator delete(void* memory) noexcept {
+	std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+	std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept {
+	std::free(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t) noexcept {
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept {
+	std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept {
+	std::free(memory);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+/*
+ * 		AllocationCounter
+ *
+ * Counts heap allocations made by the current thread. The counting
+ * operator new lives in allocation_counter.cpp and is only linked into
+ * builds configured with -DSNAKE_COUNT_ALLOCATIONS=ON; otherwise the
+ * counter stays at zero and available() is false.
+ */
+class AllocationCounter {
+public:
+	static bool available() noexcept {
+#ifdef SNAKE_COUNT_ALLOCATIONS
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	static unsigned long long count() noexcept {
+		return _count;
+	}
+
+	static void on_allocation() noexcept {
+		_count++;
+	}
+
+private:
+	static inline thread_local unsigned long long _count{0};
+};
+
+/*
+ * 		AllocationGuard
+ *
+ * Asserts a scope does not allocate, e.g. a steady-state tick. Does nothing
+ * unless armed and allocation counting is compiled in.
+ */
+class AllocationGuard {
+public:
+	AllocationGuard(const char* scope, bool armed) noexcept :
+		_scope{scope}, _armed{armed && AllocationCounter::available()}, _before{AllocationCounter::count()} {}
+
+	~AllocationGuard() {
+		if (_armed && AllocationCounter::count() != _before) {
+			std::fprintf(stderr, "%s: %llu unexpected heap allocation(s)\n",
+				     _scope, AllocationCounter::count() - _before);
+			std::abort();
+		}
+	}
+
+	AllocationGuard(const AllocationGuard&) = delete;
+	AllocationGuard& operator=(const AllocationGuard&) = delete;
+
+private:
+	const char* _scope;
+	bool _armed;
+	unsigned long long _before;
+};
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <ncurses.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "screen.h"
+#include "game.h"
+#include "bot.h"
+#include "ncurses_renderer.h"
+
+/*
+ * 		Arena
+ *
+ * Tiles the terminal with 4-16 boards, each played by a bot, so policies
+ * can be compared side by side. Every board lives in its own window and
+ * all of them are flushed with a single doupdate() per step.
+ */
+class Arena : public Screen {
+public:
+	Arena(unsigned short &width, unsigned short &height, Renderer &renderer) : Screen(width, height, renderer) {}
+
+	~Arena() override {
+		destroy_tiles();
+	}
+
+	void render() noexcept override {
+		if (_tiles.empty()) {
+			clear_once();
+			if (!build_tiles()) {
+				print_on_center("terminal is too small for the arena, press q");
+				return;
+			}
+			// Paint stdscr blank once so it never shows through later
+			renderer().present();
+		}
+		auto now = std::chrono::steady_clock::now();
+		if (now - _previous_step < _step_interval) {
+			return;
+		}
+		_previous_step = now;
+		for (auto& tile : _tiles) {
+			step(*tile);
+		}
+		doupdate();
+	}
+
+	void input_handler(int input, AppStatus& status) noexcept override {
+		switch (input) {
+			case '+':
+				_step_interval = std::max(_step_interval / 2, std::chrono::milliseconds{1});
+				break;
+			case '-':
+				_step_interval = std::min(_step_interval * 2, std::chrono::milliseconds{1000});
+				break;
+			case 'q':
+				destroy_tiles();
+				on_leave();
+				status = MENU;
+				break;
+			default:
+				break;
+		}
+	}
+
+private:
+	struct Tile {
+		Tile(WINDOW* window_, unsigned short width_, unsigned short height_, std::unique_ptr<Bot> bot_, unsigned int seed_) :
+			window{window_}, width{width_}, height{height_}, renderer{window_}, bot{std::move(bot_)}, seed{seed_}
+		{
+			game = std::make_unique<Game>(width, height, renderer, seed++);
+			bot->on_game_start();
+			games++;
+		}
+
+		void new_game() {
+			game->restart(seed++);
+			bot->on_game_start();
+			games++;
+		}
+
+		WINDOW* window;
+		unsigned short width;
+		unsigned short height;
+		NcursesWindowRenderer renderer;
+		std::unique_ptr<Bot> bot;
+		std::unique_ptr<Game> game;
+		unsigned int seed;
+		unsigned int games{0};
+		unsigned short best{0};
+	};
+
+	// Smallest board that still fits the snake's start position and the score line
+	static constexpr unsigned short min_tile_width{24};
+	static constexpr unsigned short min_tile_height{12};
+	static constexpr unsigned short max_tiles_per_side{4};
+
+	bool build_tiles() {
+		unsigned short columns = std::min<unsigned short>(max_tiles_per_side, get_width() / min_tile_width);
+		unsigned short rows = std::min<unsigned short>(max_tiles_per_side, get_height() / min_tile_height);
+		if (columns * rows < 4) {
+			return false;
+		}
+		unsigned short tile_width = get_width() / columns;
+		unsigned short tile_height = get_height() / rows;
+		for (unsigned short row = 0; row < rows; ++row) {
+			for (unsigned short column = 0; column < columns; ++column) {
+				size_t index = _tiles.size();
+				WINDOW* window = newwin(tile_height, tile_width, row * tile_height, column * tile_width);
+				auto bot = make_builtin_bot(builtin_bot_names[index % builtin_bot_names.size()], index);
+				_tiles.push_back(std::make_unique<Tile>(window, tile_width, tile_height, std::move(bot), index * 1000));
+			}
+		}
+		return true;
+	}
+
+	void destroy_tiles() noexcept {
+		for (auto& tile : _tiles) {
+			delwin(tile->window);
+		}
+		_tiles.clear();
+	}
+
+	static void step(Tile& tile) noexcept {
+		if (tile.game->status() == GAME_OVER) {
+			tile.best = std::max(tile.best, tile.game->score());
+			tile.new_game();
+		}
+		tile.game->turn(tile.bot->next_move(*tile.game));
+		tile.game->tick();
+		tile.game->draw();
+
+		char label[48];
+		int size = std::snprintf(label, sizeof(label), " %s #%u best %u ",
+					 tile.bot->name(), tile.games, tile.best);
+		tile.renderer.draw_border();
+		tile.renderer.put(0, 2, std::string_view(label, std::min<int>(size, tile.width - 4)));
+		tile.renderer.present();
+	}
+
+	std::vector<std::unique_ptr<Tile>> _tiles;
+	std::chrono::steady_clock::time_point _previous_step;
+	std::chrono::milliseconds _step_interval{50};
+};
@@ -0,0 +1,416 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "framebuffer_renderer.h"
+#include "game.h"
+#include "bot.h"
+#include "plugin_bot.h"
+#include "tiled_world.h"
+#include "trace.h"
+#include "allocation_counter.h"
+#include "perf_counters.h"
+#include "bench_results.h"
+
+namespace {
+
+// Ticks before --assert-no-alloc kicks in; the first ones may set up lazily created buffers
+constexpr unsigned long warmup_ticks{100};
+
+struct BenchOptions {
+	unsigned short width{80};
+	unsigned short height{24};
+	unsigned long ticks{100000};
+	unsigned int seed{42};
+	bool dump{false};
+	bool compose{false};
+	bool scenarios{false};
+	bool assert_no_alloc{false};
+	const char* trace_path{nullptr};
+	const char* results_path{nullptr};
+	unsigned int repeat{1};
+	unsigned int threads{std::thread::hardware_concurrency()};
+	const char* bot{"greedy"};
+	unsigned int lanes{0};		// games per external bot process; 0 plays a single game
+	unsigned int deadline_us{static_cast<unsigned int>(ExternalBotProcess::default_deadline.count())};
+};
+
+BenchOptions parse_options(int argc, char** argv) {
+	BenchOptions options;
+	for (int i = 1; i < argc; ++i) {
+		if (!std::strcmp(argv[i], "--dump")) {
+			options.dump = true;
+		} else if (!std::strcmp(argv[i], "--assert-no-alloc")) {
+			options.assert_no_alloc = true;
+		} else if (!std::strcmp(argv[i], "--scenarios")) {
+			options.scenarios = true;
+		} else if (!std::strcmp(argv[i], "--compose")) {
+			options.compose = true;
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--trace")) {
+			options.trace_path = argv[++i];
+			Trace::enable();
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--results")) {
+			options.results_path = argv[++i];
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--repeat")) {
+			options.repeat = std::max(1, std::atoi(argv[++i]));
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--threads")) {
+			options.threads = std::atoi(argv[++i]);
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--width")) {
+			options.width = std::atoi(argv[++i]);
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--height")) {
+			options.height = std::atoi(argv[++i]);
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--ticks")) {
+			options.ticks = std::strtoul(argv[++i], nullptr, 10);
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--seed")) {
+			options.seed = std::strtoul(argv[++i], nullptr, 10);
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--lanes")) {
+			options.lanes = std::max(1, std::atoi(argv[++i]));
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--deadline-us")) {
+			options.deadline_us = std::strtoul(argv[++i], nullptr, 10);
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--bot")) {
+			options.bot = argv[++i];
+			std::string error;
+			if (std::strncmp(options.bot, "exec:", 5) && !make_bot(options.bot, 0, &error)) {
+				std::fprintf(stderr, "%s\n", error.c_str());
+				std::exit(1);
+			}
+		} else {
+			std::fprintf(stderr, "usage: %s [--width W] [--height H] [--ticks N] [--seed S] [--dump] [--assert-no-alloc] [--bot NAME|PLUGIN.so]\n\t[--bot exec:COMMAND [--lanes N] [--deadline-us US]]\t[--scenarios] [--compose [--threads T]] [--trace FILE]\n\t[--repeat N] [--results FILE]\n", argv[0]);
+			std::exit(1);
+		}
+	}
+	if (options.lanes != 0 && std::strncmp(options.bot, "exec:", 5)) {
+		std::fprintf(stderr, "--lanes needs an external bot (--bot exec:COMMAND)\n");
+		std::exit(1);
+	}
+	return options;
+}
+
+// Frame composition of a wall-sized tiled world, for 1, 2, 4 ... threads
+void run_compose(const BenchOptions& options, BenchResults& results) {
+	int null_fd = open("/dev/null", O_WRONLY);
+	std::printf("viewport %ux%u, %lu frames\n", options.width, options.height, options.ticks);
+	std::printf("%-8s %-6s %-12s %-12s %-8s %-12s\n", "threads", "tiles", "compose ms", "emit ms", "speedup", "ticks/sec");
+	double single_thread = 0;
+	for (unsigned int threads = 1; threads <= std::max(options.threads, 1u); threads *= 2) {
+		ThreadPool pool(threads);
+		TiledWorld world(options.width, options.height, 24, 12, pool, options.seed);
+		std::chrono::duration<double> compose{0}, emit{0};
+		for (unsigned long frame = 0; frame < options.ticks; ++frame) {
+			auto started = std::chrono::steady_clock::now();
+			world.step();
+			auto composed = std::chrono::steady_clock::now();
+			world.emit(null_fd, CELL_DIFF);
+			compose += composed - started;
+			emit += std::chrono::steady_clock::now() - composed;
+		}
+		double compose_ms = compose.count() * 1e3 / options.ticks;
+		if (threads == 1) {
+			single_thread = compose_ms;
+		}
+		std::printf("%-8u %-6zu %-12.3f %-12.3f %-8.2f %-12.0f\n", threads, world.tiles(), compose_ms,
+			    emit.count() * 1e3 / options.ticks, single_thread / compose_ms, world.ticks() / compose.count());
+		results.add("compose." + std::to_string(threads) + "t.ms_per_frame", false, compose_ms);
+	}
+	close(null_fd);
+}
+
+// Time and hardware counters of one engine operation, averaged over iterations
+template <typename Operation>
+void run_scenario(const char* name, unsigned long iterations, PerfCounters& counters, BenchResults& results,
+		  Operation&& operation) {
+	auto started = std::chrono::steady_clock::now();
+	counters.start();
+	for (unsigned long i = 0; i < iterations; ++i) {
+		operation();
+	}
+	PerfCounters::Reading reading = counters.stop();
+	std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - started;
+
+	std::string key = "scenario." + std::string(name) + ".";
+	std::replace(key.begin(), key.end(), ' ', '_');
+	results.add(key + "ns_per_op", false, elapsed.count() / iterations);
+
+	std::printf("%-16s %10.1f", name, elapsed.count() / iterations);
+	if (counters.available()) {
+		results.add(key + "cycles_per_op", false, static_cast<double>(reading[PerfCounters::CYCLES]) / iterations);
+		results.add(key + "instructions_per_op", false, static_cast<double>(reading[PerfCounters::INSTRUCTIONS]) / iterations);
+		double cycles = static_cast<double>(reading[PerfCounters::CYCLES]);
+		double instructions = static_cast<double>(reading[PerfCounters::INSTRUCTIONS]);
+		std::printf(" %10.1f %10.1f %6.2f %10.3f %10.3f", cycles / iterations, instructions / iterations,
+			    cycles ? instructions / cycles : 0.0,
+			    static_cast<double>(reading[PerfCounters::CACHE_MISSES]) / iterations,
+			    static_cast<double>(reading[PerfCounters::BRANCH_MISSES]) / iterations);
+	}
+	std::printf("\n");
+}
+
+// Per-tick cost of the engine's hot paths, in time and (when permitted) hardware counters
+void run_scenarios(const BenchOptions& options, BenchResults& results) {
+	constexpr unsigned short snake_length{200};
+	constexpr unsigned short loop_side{20};
+	PerfCounters counters;
+
+	// A long snake walking a square loop exercises advance and the self-collision scan
+	Snake snake{loop_side, loop_side, Right, snake_length};
+	unsigned long steps = 0;
+	auto walk = [&snake, &steps] {
+		if (++steps % loop_side == 0) {
+			snake.setDirection(static_cast<Direction>((snake.getDirection() + 1) % 4));
+		}
+		snake.advance();
+	};
+	while (snake.body().size() < snake_length) {
+		snake.grow_up();
+		walk();
+	}
+
+	// A game played for a while, for food placement and frame composition
+	unsigned short width = options.width;
+	unsigned short height = options.height;
+	FramebufferRenderer framebuffer(width, height);
+	Game game(width, height, framebuffer, options.seed);
+	GreedyBot bot;
+	for (int tick = 0; tick < 2000 && game.status() != GAME_OVER; ++tick) {
+		game.turn(bot.next_move(game));
+		game.tick();
+	}
+
+	std::printf("board %ux%u, snake length %u (advance/collision), %u (food/compose)\n",
+		    width, height, snake_length, static_cast<unsigned>(game.snake().body().size()));
+	std::printf("%-16s %10s", "scenario", "ns/op");
+	if (counters.available()) {
+		std::printf(" %10s %10s %6s %10s %10s", "cycles", "instr", "IPC", "cache-miss", "br-miss");
+	} else {
+		std::printf("  (hardware counters unavailable: perf_event_open refused)");
+	}
+	std::printf("\n");
+
+	volatile bool sink = false;
+	run_scenario("body advance", options.ticks, counters, results, walk);
+	run_scenario("collision", options.ticks, counters, results, [&snake, &sink] {
+		sink = snake.check_self_abuse();
+	});
+	run_scenario("food placement", options.ticks, counters, results, [&game] {
+		game.generate_food();
+	});
+	run_scenario("frame compose", options.ticks, counters, results, [&game, &framebuffer] {
+		game.draw();
+		framebuffer.draw_border();
+		framebuffer.present();
+	});
+	// One tail-reachability query; "cold" also rebuilds the body's release times
+	TailOracle oracle;
+	run_scenario("tail reach", options.ticks, counters, results, [&game, &oracle, &sink, &steps] {
+		sink = oracle.tail_reachable_after(game, static_cast<Direction>(++steps % 4));
+	});
+	run_scenario("tail reach cold", options.ticks, counters, results, [&game, &oracle, &sink, &steps] {
+		oracle.invalidate();
+		sink = oracle.tail_reachable_after(game, static_cast<Direction>(++steps % 4));
+	});
+	// Mirroring the game into a mapped checkpoint file, as SnakeGame does every tick
+	char checkpoint_path[] = "/tmp/snake-bench-checkpoint-XXXXXX";
+	int checkpoint_fd = mkstemp(checkpoint_path);
+	Checkpoint checkpoint;
+	if (checkpoint_fd >= 0 && checkpoint.open(checkpoint_path, width, height)) {
+		game.attach_checkpoint(checkpoint);
+		run_scenario("checkpoint save", options.ticks, counters, results, [&game] {
+			game.save_checkpoint();
+		});
+	}
+	if (checkpoint_fd >= 0) {
+		unlink(checkpoint_path);
+		close(checkpoint_fd);
+	}
+	// What the Info screen pays to read the shared leaderboard, and a game to rank itself
+	char leaderboard_path[] = "/tmp/snake-bench-leaderboard-XXXXXX";
+	int leaderboard_fd = mkstemp(leaderboard_path);
+	Leaderboard leaderboard;
+	if (leaderboard_fd >= 0 && leaderboard.open(leaderboard_path)) {
+		LeaderboardTables tables;
+		std::uint64_t sequence = 0;
+		run_scenario("leaderboard rank", options.ticks, counters, results, [&leaderboard, &steps, width, height] {
+			leaderboard.record(++steps % 1000 + 1, width, height);
+		});
+		run_scenario("leaderboard read", options.ticks, counters, results, [&leaderboard, &tables, &sequence] {
+			leaderboard.snapshot(tables, sequence);
+		});
+	}
+	if (leaderboard_fd >= 0) {
+		unlink(leaderboard_path);
+		close(leaderboard_fd);
+	}
+}
+
+void run_play(const BenchOptions& options, BenchResults& results) {
+	unsigned short width = options.width;
+	unsigned short height = options.height;
+	FramebufferRenderer framebuffer(width, height);
+	auto game = std::make_unique<Game>(width, height, framebuffer, options.seed);
+	std::string error;
+	std::unique_ptr<Bot> bot = make_bot(options.bot, options.seed, &error, std::chrono::microseconds{options.deadline_us});
+	if (!bot) {
+		std::fprintf(stderr, "%s\n", error.c_str());
+		std::exit(1);
+	}
+	unsigned long games = 1;
+	unsigned long long total_score = 0;
+	std::chrono::steady_clock::duration thinking{0}, slowest_move{0};
+
+	unsigned long long allocations = 0;
+
+	auto started = std::chrono::steady_clock::now();
+	for (unsigned long tick = 0; tick < options.ticks; ++tick) {
+		if (game->status() == GAME_OVER) {
+			total_score += game->score();
+			game->restart(options.seed + games++);
+			bot->on_game_start();
+		}
+		auto allocations_before = AllocationCounter::count();
+		{
+			AllocationGuard guard("steady-state tick", options.assert_no_alloc && tick >= warmup_ticks);
+			auto thinking_since = std::chrono::steady_clock::now();
+			Direction move = bot->next_move(*game);
+			auto thought = std::chrono::steady_clock::now() - thinking_since;
+			thinking += thought;
+			slowest_move = std::max(slowest_move, thought);
+			game->turn(move);
+			game->tick();
+			game->draw();
+			framebuffer.draw_border();
+			TraceSpan span("present");
+			framebuffer.present();
+		}
+		allocations += AllocationCounter::count() - allocations_before;
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+
+	const FrameStats& stats = framebuffer.stats();
+	std::printf("board       %ux%u\n", width, height);
+	std::printf("ticks       %lu (%lu games)\n", options.ticks, games);
+	std::printf("ticks/sec   %.0f\n", options.ticks / elapsed.count());
+	std::printf("ns/tick     %.1f\n", elapsed.count() * 1e9 / options.ticks);
+	std::printf("bot         %s, %.1f us/move (max %.1f us), %.1f score/game\n", bot->name(),
+		    std::chrono::duration<double, std::micro>(thinking).count() / options.ticks,
+		    std::chrono::duration<double, std::micro>(slowest_move).count(),
+		    static_cast<double>(total_score + game->score()) / games);
+	if (AllocationCounter::available()) {
+		std::printf("allocs/tick %.3f\n", static_cast<double>(allocations) / options.ticks);
+	} else {
+		std::printf("allocs/tick n/a (configure with -DSNAKE_COUNT_ALLOCATIONS=ON)\n");
+	}
+	const char* strategy_names[output_strategies_count] = {"full", "row-diff", "cell-diff"};
+	for (int strategy = 0; strategy < output_strategies_count; ++strategy) {
+		std::printf("bytes/frame %-9s %.1f\n", strategy_names[strategy],
+			    static_cast<double>(stats.bytes[strategy]) / stats.frames);
+		results.add(std::string("play.bytes_per_frame.") + strategy_names[strategy], false,
+			    static_cast<double>(stats.bytes[strategy]) / stats.frames);
+	}
+	results.add("play.ticks_per_sec", true, options.ticks / elapsed.count());
+	results.add("play.ns_per_tick", false, elapsed.count() * 1e9 / options.ticks);
+	results.add("play.bot_ns_per_move", false, std::chrono::duration<double, std::nano>(thinking).count() / options.ticks);
+	if (AllocationCounter::available()) {
+		results.add("play.allocs_per_tick", false, static_cast<double>(allocations) / options.ticks);
+	}
+	if (options.dump) {
+		std::fputs(framebuffer.to_string().c_str(), stdout);
+	}
+}
+
+// Games in lockstep against one external bot process, one round per tick
+void run_external(const BenchOptions& options, BenchResults& results) {
+	unsigned short width = options.width;
+	unsigned short height = options.height;
+	unsigned int lanes = std::max(options.lanes, 1u);
+	FramebufferRenderer unused(width, height);
+	std::vector<std::unique_ptr<Game>> games;
+	std::vector<const Game*> views;
+	for (unsigned int lane = 0; lane < lanes; ++lane) {
+		games.push_back(std::make_unique<Game>(width, height, unused, options.seed + lane));
+		views.push_back(games.back().get());
+	}
+	ExternalBotProcess bot(options.bot + 5, lanes, std::chrono::microseconds{options.deadline_us});
+	if (!bot.running()) {
+		std::fprintf(stderr, "cannot start %s: %s\n", options.bot + 5, bot.error().c_str());
+		std::exit(1);
+	}
+	std::vector<Direction> moves(lanes);
+	unsigned long finished = 0;
+	unsigned long long total_score = 0;
+	unsigned long rounds = std::max(1ul, options.ticks / lanes);
+
+	auto started = std::chrono::steady_clock::now();
+	for (unsigned long round = 0; round < rounds; ++round) {
+		bot.next_moves(views.data(), lanes, moves.data());
+		for (unsigned int lane = 0; lane < lanes; ++lane) {
+			Game& game = *games[lane];
+			game.turn(moves[lane]);
+			game.tick();
+			if (game.status() == GAME_OVER) {
+				total_score += game.score();
+				finished++;
+				game.restart(options.seed + lanes * finished + lane);
+				bot.on_game_start(lane);
+			}
+		}
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+
+	if (!bot.running()) {
+		std::fprintf(stderr, "%s: %s\n", options.bot + 5, bot.error().c_str());
+		std::exit(1);
+	}
+	const ExternalBotProcess::Stats& stats = bot.stats();
+	double moves_made = static_cast<double>(rounds) * lanes;
+	std::printf("board       %ux%u, %u game(s) per process, deadline %u us\n", width, height, lanes, options.deadline_us);
+	std::printf("rounds      %llu (%llu late), %lu games finished, %.1f score/game\n", stats.rounds, stats.timeouts,
+		    finished, finished ? static_cast<double>(total_score) / finished : 0.0);
+	std::printf("moves/sec   %.0f\n", moves_made / elapsed.count());
+	std::printf("us/round    %.1f\n", elapsed.count() * 1e6 / rounds);
+	std::printf("syscalls    %.3f per move\n", stats.syscalls / moves_made);
+	std::printf("bytes       %.1f sent, %.1f received per move\n", stats.bytes_sent / moves_made,
+		    stats.bytes_received / moves_made);
+	results.add("external.moves_per_sec", true, moves_made / elapsed.count());
+	results.add("external.syscalls_per_move", false, stats.syscalls / moves_made);
+	results.add("external.late_rounds", false, static_cast<double>(stats.timeouts));
+}
+
+} // local namespace
+
+int main(int argc, char** argv) {
+	BenchOptions options = parse_options(argc, argv);
+	BenchResults results;
+	for (unsigned int run = 0; run < options.repeat; ++run) {
+		if (options.compose) {
+			run_compose(options, results);
+		} else if (options.scenarios) {
+			run_scenarios(options, results);
+		} else if (options.lanes != 0) {
+			run_external(options, results);
+		} else {
+			run_play(options, results);
+		}
+	}
+	if (options.repeat > 1) {
+		std::printf("\n%-40s %14s %12s\n", "metric", "mean", "stddev");
+		for (const auto& [name, metric] : results.metrics()) {
+			std::printf("%-40s %14.3f %12.3f\n", name.c_str(), metric.mean(), metric.stddev());
+		}
+	}
+	if (options.results_path && !results.save(options.results_path)) {
+		std::fprintf(stderr, "cannot write results to %s\n", options.results_path);
+		return 1;
+	}
+	if (options.trace_path && !Trace::write(options.trace_path)) {
+		std::fprintf(stderr, "cannot write trace to %s\n", options.trace_path);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,120 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "bench_results.h"
+
+namespace {
+
+// Continued fraction for the regularized incomplete beta function (Lentz's method)
+double beta_continued_fraction(double a, double b, double x) {
+	constexpr double tiny = 1e-300;
+	double c = 1, d = 1 - (a + b) * x / (a + 1);
+	d = 1 / (std::fabs(d) < tiny ? tiny : d);
+	double result = d;
+	for (int m = 1; m <= 200; ++m) {
+		double numerator = m * (b - m) * x / ((a + 2 * m - 1) * (a + 2 * m));
+		d = 1 + numerator * d;
+		c = 1 + numerator / c;
+		d = 1 / (std::fabs(d) < tiny ? tiny : d);
+		c = std::fabs(c) < tiny ? tiny : c;
+		result *= d * c;
+		numerator = -(a + m) * (a + b + m) * x / ((a + 2 * m) * (a + 2 * m + 1));
+		d = 1 + numerator * d;
+		c = 1 + numerator / c;
+		d = 1 / (std::fabs(d) < tiny ? tiny : d);
+		c = std::fabs(c) < tiny ? tiny : c;
+		double step = d * c;
+		result *= step;
+		if (std::fabs(step - 1) < 1e-12) {
+			break;
+		}
+	}
+	return result;
+}
+
+double incomplete_beta(double a, double b, double x) {
+	if (x <= 0 || x >= 1) {
+		return x <= 0 ? 0 : 1;
+	}
+	double front = std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) +
+				a * std::log(x) + b * std::log(1 - x));
+	if (x < (a + 1) / (a + b + 2)) {
+		return front * beta_continued_fraction(a, b, x) / a;
+	}
+	return 1 - front * beta_continued_fraction(b, a, 1 - x) / b;
+}
+
+// Two-sided p-value of Welch's t-test; 1 when there are too few samples to tell
+double welch_p_value(const BenchResults::Metric& baseline, const BenchResults::Metric& current) {
+	size_t n1 = baseline.samples.size(), n2 = current.samples.size();
+	if (n1 < 2 || n2 < 2) {
+		return 1;
+	}
+	double v1 = baseline.variance() / n1, v2 = current.variance() / n2;
+	if (v1 + v2 == 0) {
+		return baseline.mean() == current.mean() ? 1 : 0;
+	}
+	double t = (current.mean() - baseline.mean()) / std::sqrt(v1 + v2);
+	double df = (v1 + v2) * (v1 + v2) / (v1 * v1 / (n1 - 1) + v2 * v2 / (n2 - 1));
+	return incomplete_beta(df / 2, 0.5, df / (df + t * t));
+}
+
+} // local namespace
+
+int main(int argc, char** argv) {
+	double threshold = 5;	// percent
+	double alpha = 0.05;
+	const char* paths[2] = {nullptr, nullptr};
+	int positional = 0;
+	for (int i = 1; i < argc; ++i) {
+		if (i + 1 < argc && !std::strcmp(argv[i], "--threshold")) {
+			threshold = std::atof(argv[++i]);
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--alpha")) {
+			alpha = std::atof(argv[++i]);
+		} else if (positional < 2 && argv[i][0] != '-') {
+			paths[positional++] = argv[i];
+		} else {
+			positional = 0;
+			break;
+		}
+	}
+	if (positional != 2) {
+		std::fprintf(stderr, "usage: %s BASELINE CURRENT [--threshold PERCENT] [--alpha P]\n", argv[0]);
+		return 2;
+	}
+
+	BenchResults baseline, current;
+	if (!baseline.load(paths[0]) || !current.load(paths[1])) {
+		std::fprintf(stderr, "cannot read %s or %s\n", paths[0], paths[1]);
+		return 2;
+	}
+
+	int regressions = 0;
+	std::printf("%-40s %14s %14s %9s %8s\n", "metric", "baseline", "current", "change", "p");
+	for (const auto& [name, now] : current.metrics()) {
+		auto before = baseline.metrics().find(name);
+		if (before == baseline.metrics().end()) {
+			std::printf("%-40s %14s %14.3f\n", name.c_str(), "-", now.mean());
+			continue;
+		}
+		const BenchResults::Metric& then = before->second;
+		double change = then.mean() != 0 ? (now.mean() - then.mean()) / then.mean() * 100 : 0;
+		double worse_by = now.higher_is_better ? -change : change;
+		double p = welch_p_value(then, now);
+		const char* verdict = "";
+		if (p < alpha && worse_by > threshold) {
+			verdict = "  REGRESSION";
+			regressions++;
+		} else if (p < alpha && -worse_by > threshold) {
+			verdict = "  improved";
+		}
+		std::printf("%-40s %14.3f %14.3f %+8.1f%% %8.4f%s\n", name.c_str(), then.mean(), now.mean(), change, p, verdict);
+	}
+	if (regressions) {
+		std::printf("%d regression(s) beyond %.1f%% at p < %.2f\n", regressions, threshold, alpha);
+	}
+	return regressions ? 1 : 0;
+}
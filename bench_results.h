@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+ * 		BenchResults
+ *
+ * Samples of every benchmark metric, one sample per repetition. Saved as
+ * text, one metric per line: "name higher|lower sample sample ...", where
+ * the second field says which direction is an improvement. A saved run
+ * serves as the baseline for SnakeBenchCompare.
+ */
+class BenchResults {
+public:
+	struct Metric {
+		bool higher_is_better{false};
+		std::vector<double> samples;
+
+		double mean() const noexcept {
+			return samples.empty() ? 0 : std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+		}
+
+		double variance() const noexcept {
+			if (samples.size() < 2) {
+				return 0;
+			}
+			double average = mean(), sum = 0;
+			for (double sample : samples) {
+				sum += (sample - average) * (sample - average);
+			}
+			return sum / (samples.size() - 1);
+		}
+
+		double stddev() const noexcept {
+			return std::sqrt(variance());
+		}
+	};
+
+	void add(const std::string& name, bool higher_is_better, double sample) {
+		Metric& metric = _metrics[name];
+		metric.higher_is_better = higher_is_better;
+		metric.samples.push_back(sample);
+	}
+
+	const std::map<std::string, Metric>& metrics() const noexcept {
+		return _metrics;
+	}
+
+	bool save(const std::string& path) const {
+		std::ofstream file(path);
+		file << "# SnakeBench results: metric higher|lower samples...\n";
+		for (const auto& [name, metric] : _metrics) {
+			file << name << (metric.higher_is_better ? " higher" : " lower");
+			for (double sample : metric.samples) {
+				file << ' ' << sample;
+			}
+			file << '\n';
+		}
+		return static_cast<bool>(file);
+	}
+
+	bool load(const std::string& path) {
+		std::ifstream file(path);
+		if (!file) {
+			return false;
+		}
+		std::string line;
+		while (std::getline(file, line)) {
+			if (line.empty() || line[0] == '#') {
+				continue;
+			}
+			std::istringstream fields(line);
+			std::string name, direction;
+			if (!(fields >> name >> direction) || (direction != "higher" && direction != "lower")) {
+				return false;
+			}
+			Metric& metric = _metrics[name];
+			metric.higher_is_better = direction == "higher";
+			for (double sample; fields >> sample; ) {
+				metric.samples.push_back(sample);
+			}
+		}
+		return true;
+	}
+
+private:
+	std::map<std::string, Metric> _metrics;
+};
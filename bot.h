@@ -0,0 +1,357 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string_view>
+#include <vector>
+
+#include "types.h"
+#include "game.h"
+#include "tail_oracle.h"
+
+/*
+ * 		Bot
+ *
+ * A policy that picks the next direction for a Game. Bots only get a const
+ * view; the caller applies the move with Game::turn().
+ */
+class Bot {
+public:
+	virtual ~Bot() = default;
+
+	virtual const char * name() const noexcept = 0;
+	virtual Direction next_move(const Game& game) noexcept = 0;
+
+	// Called before the first move of every new game
+	virtual void on_game_start() noexcept {}
+
+protected:
+	// Whether the head can still reach the tail after this move, i.e. it does not box the snake in
+	bool keeps_tail_reachable(const Game& game, Direction direction) noexcept {
+		return _tail_oracle.tail_reachable_after(game, direction);
+	}
+
+private:
+	TailOracle _tail_oracle;
+};
+
+// The move neither reverses the snake, hits a wall nor bites the body.
+// The tail cell counts as free: it moves away on the same tick.
+inline bool is_safe_move(const Game& game, Direction direction) noexcept {
+	const Snake& snake = game.snake();
+	if (snake.body().size() > 1 && direction == opposite(snake.getDirection())) {
+		return false;
+	}
+	auto [x, y] = next_cell(snake.getHead(), direction);
+	if (!Game::is_inside({x, y}, game.get_width(), game.get_height())) {
+		return false;
+	}
+	const auto& body = snake.body();
+	return std::none_of(body.cbegin(), body.cend() - 1,
+			    [x = x, y = y](const coordinates& part) {
+				    return part.first == x && part.second == y;
+			    }
+	);
+}
+
+constexpr std::array<Direction, 4> all_directions{ {Up, Right, Down, Left} };
+
+/*
+ * 		GreedyBot
+ *
+ * Heads for the food, vetoing moves that would cut the head off from the
+ * tail. When the food cannot be reached without such a move the veto keeps
+ * the snake circling, so after a board's worth of ticks without eating the
+ * bot drops it and takes the shortest safe move until it eats again.
+ */
+class GreedyBot : public Bot {
+public:
+	const char * name() const noexcept override {
+		return "greedy";
+	}
+
+	void on_game_start() noexcept override {
+		_last_score = 0;
+		_hungry_ticks = 0;
+	}
+
+	// Closest to the food among the moves that keep the tail in reach, or among
+	// merely safe ones when none does or the snake has gone hungry too long
+	Direction next_move(const Game& game) noexcept override {
+		if (game.score() != _last_score) {
+			_last_score = game.score();
+			_hungry_ticks = 0;
+		}
+		bool starving = ++_hungry_ticks > static_cast<unsigned long>(game.get_width()) * game.get_height();
+		Direction best = game.snake().getDirection();
+		int best_distance = -1;
+		bool best_roomy = false;
+		for (Direction direction : all_directions) {
+			if (!is_safe_move(game, direction)) {
+				continue;
+			}
+			bool roomy = !starving && keeps_tail_reachable(game, direction);
+			auto [x, y] = next_cell(game.snake().getHead(), direction);
+			int distance = std::abs(x - game.food().first) + std::abs(y - game.food().second);
+			if (best_distance < 0 || roomy > best_roomy || (roomy == best_roomy && distance < best_distance)) {
+				best = direction;
+				best_distance = distance;
+				best_roomy = roomy;
+			}
+		}
+		return best;
+	}
+
+private:
+	unsigned int _last_score{0};
+	unsigned long _hungry_ticks{0};
+};
+
+/*
+ * 		RandomBot
+ */
+class RandomBot : public Bot {
+public:
+	explicit RandomBot(unsigned int seed) : _random_generator(seed) {}
+
+	const char * name() const noexcept override {
+		return "random";
+	}
+
+	Direction next_move(const Game& game) noexcept override {
+		std::array<Direction, 4> safe{};
+		size_t count = 0;
+		for (Direction direction : all_directions) {
+			if (is_safe_move(game, direction)) {
+				safe[count++] = direction;
+			}
+		}
+		if (count == 0) {
+			return game.snake().getDirection();
+		}
+		// Prefer going straight, turn now and then
+		if (is_safe_move(game, game.snake().getDirection()) && _random_generator() % 4 != 0) {
+			return game.snake().getDirection();
+		}
+		return safe[_random_generator() % count];
+	}
+
+private:
+	std::mt19937 _random_generator;
+};
+
+/*
+ * 		BeamBot
+ *
+ * Looks ahead by keeping the best beam_width futures at each depth, scored
+ * by distance to the food (or how soon it was eaten) and by how much room
+ * the head has left. Candidate bodies live in two arenas that swap roles
+ * every depth and are reset every tick; they are sized once per board, so
+ * a move allocates nothing. The search stops deepening once it has used
+ * budget_fraction of the game's tick interval, or, with a node budget,
+ * once it has expanded that many futures. The time budget adapts to the
+ * machine but makes moves depend on its speed and load; the node budget
+ * plays the same moves everywhere.
+ */
+class BeamBot : public Bot {
+public:
+	using clock = std::chrono::steady_clock;
+
+	explicit BeamBot(unsigned int beam_width = 16, unsigned int max_depth = 16, double budget_fraction = 0.25,
+			 unsigned int node_budget = 0) noexcept :
+		_beam_width{std::max(beam_width, 1u)}, _max_depth{std::max(max_depth, 1u)}, _budget_fraction{budget_fraction},
+		_node_budget{node_budget} {}
+
+	const char * name() const noexcept override {
+		return "beam";
+	}
+
+	Direction next_move(const Game& game) noexcept override {
+		auto deadline = clock::now() +
+			std::chrono::duration_cast<clock::duration>(game.tick_interval() * _budget_fraction);
+		prepare(game.get_width(), game.get_height());
+
+		const Snake& snake = game.snake();
+		Generation* current = &_generations[0];
+		Generation* next = &_generations[1];
+		current->reset();
+		current->nodes.push_back(Node{0, static_cast<unsigned short>(snake.body().size()), snake.getDirection(),
+					      snake.getDirection(), snake.growing(), 0, 0});
+		std::copy(snake.body().begin(), snake.body().end(), current->cells.begin());
+
+		Direction best = snake.getDirection();
+		unsigned int expanded = 0;
+		for (unsigned int depth = 1; depth <= _max_depth; ++depth) {
+			next->reset();
+			bool finished = true;
+			for (const Node& parent : current->nodes) {
+				// A half-expanded depth would favour the parents that came first
+				if (depth > 1 && (_node_budget ? expanded >= _node_budget : clock::now() >= deadline)) {
+					finished = false;
+					break;
+				}
+				expand(game, *current, parent, depth, *next);
+				expanded++;
+			}
+			if (!finished || next->nodes.empty()) {
+				break;
+			}
+			if (next->nodes.size() > _beam_width) {
+				std::nth_element(next->nodes.begin(), next->nodes.begin() + _beam_width, next->nodes.end(),
+						 [](const Node& a, const Node& b) { return a.score > b.score; });
+				next->nodes.resize(_beam_width);
+			}
+			best = std::max_element(next->nodes.begin(), next->nodes.end(),
+						[](const Node& a, const Node& b) { return a.score < b.score; })->first_move;
+			std::swap(current, next);
+		}
+		return best;
+	}
+
+private:
+	struct Node {
+		unsigned int body;	// offset of the head in its generation's cells
+		unsigned short length;
+		Direction direction;
+		Direction first_move;
+		bool growing;
+		unsigned char ate_at;	// depth the food was eaten at, 0 while it is still out
+		int score;
+	};
+
+	struct Generation {
+		std::vector<coordinates> cells;
+		std::vector<Node> nodes;
+		size_t used{0};
+
+		void reset() noexcept {
+			nodes.clear();
+			used = 0;
+		}
+	};
+
+	// Arenas for the largest possible beam on this board; a no-op after the first move
+	void prepare(unsigned short width, unsigned short height) {
+		if (width == _width && height == _height) {
+			return;
+		}
+		_width = width;
+		_height = height;
+		size_t cells = static_cast<size_t>(width) * height;
+		for (Generation& generation : _generations) {
+			generation.nodes.reserve(_beam_width * 3);
+			generation.cells.resize(_beam_width * 3 * (cells + 1));
+		}
+		_stamps.assign(cells, 0);
+		_queue.resize(cells);
+		_stamp = 0;
+	}
+
+	void expand(const Game& game, const Generation& from, const Node& parent, unsigned int depth, Generation& to) noexcept {
+		const coordinates* body = from.cells.data() + parent.body;
+		for (Direction direction : all_directions) {
+			// Game::turn ignores reversing, so that would just repeat going straight
+			if (direction == opposite(parent.direction)) {
+				continue;
+			}
+			coordinates head = next_cell(body[0], direction);
+			if (!Game::is_inside(head, _width, _height)) {
+				continue;
+			}
+			// The tail moves out of the way unless the snake just ate
+			unsigned short kept = parent.growing ? parent.length : parent.length - 1;
+			if (std::find(body, body + kept, head) != body + kept) {
+				continue;
+			}
+			Node child{static_cast<unsigned int>(to.used), static_cast<unsigned short>(kept + 1), direction,
+				   depth == 1 ? direction : parent.first_move, false, parent.ate_at, 0};
+			coordinates* cells = to.cells.data() + to.used;
+			cells[0] = head;
+			std::copy(body, body + kept, cells + 1);
+			to.used += child.length;
+			if (child.ate_at == 0 && head == game.food()) {
+				child.ate_at = depth;
+				child.growing = true;
+			}
+			child.score = evaluate(game, child, cells);
+			to.nodes.push_back(child);
+		}
+	}
+
+	int evaluate(const Game& game, const Node& node, const coordinates* body) noexcept {
+		int score = room(node, body);
+		if (score < node.length) {
+			score -= 1000;	// probably boxed in
+		}
+		if (node.ate_at != 0) {
+			return score + 2000 - 50 * node.ate_at;
+		}
+		return score - 4 * (std::abs(body[0].first - game.food().first) + std::abs(body[0].second - game.food().second));
+	}
+
+	// Cells the head can reach, flood-filled up to a cap that is plenty to keep moving
+	int room(const Node& node, const coordinates* body) noexcept {
+		if (++_stamp == 0) {
+			std::fill(_stamps.begin(), _stamps.end(), 0);
+			_stamp = 1;
+		}
+		unsigned short blocked = node.growing ? node.length : node.length - 1;
+		for (unsigned short i = 0; i < blocked; ++i) {
+			_stamps[index(body[i])] = _stamp;
+		}
+		int cap = std::min<int>(2 * node.length + 16, _stamps.size());
+		int reached = 0;
+		size_t head = 0, tail = 0;
+		_queue[tail++] = body[0];
+		while (head < tail && reached < cap) {
+			coordinates cell = _queue[head++];
+			for (Direction direction : all_directions) {
+				coordinates neighbour = next_cell(cell, direction);
+				if (Game::is_inside(neighbour, _width, _height) && _stamps[index(neighbour)] != _stamp) {
+					_stamps[index(neighbour)] = _stamp;
+					_queue[tail++] = neighbour;
+					reached++;
+				}
+			}
+		}
+		return reached;
+	}
+
+	size_t index(coordinates cell) const noexcept {
+		return static_cast<size_t>(cell.second) * _width + cell.first;
+	}
+
+	unsigned int _beam_width;
+	unsigned int _max_depth;
+	double _budget_fraction;
+	unsigned int _node_budget;	// futures expanded per move; 0 budgets time instead
+	unsigned short _width{0};
+	unsigned short _height{0};
+	std::array<Generation, 2> _generations;
+	std::vector<std::uint32_t> _stamps;	// flood fill visited marks, by generation
+	std::uint32_t _stamp{0};
+	std::vector<coordinates> _queue;
+};
+
+constexpr std::array<std::string_view, 3> builtin_bot_names{ {"greedy", "random", "beam"} };
+
+// nullptr for an unknown name
+// `search_nodes` caps how many futures a searching bot expands per move, so
+// it plays the same on any machine; 0 lets it search for part of each tick
+inline std::unique_ptr<Bot> make_builtin_bot(std::string_view name, unsigned int seed, unsigned int search_nodes = 0) {
+	if (name == "greedy") {
+		return std::make_unique<GreedyBot>();
+	}
+	if (name == "random") {
+		return std::make_unique<RandomBot>(seed);
+	}
+	if (name == "beam") {
+		return std::make_unique<BeamBot>(16, 16, 0.25, search_nodes);
+	}
+	return nullptr;
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#include "types.h"
+
+/*
+ * 		CheckpointState
+ *
+ * Everything needed to continue a game, apart from the body cells that
+ * follow it in the slot: the food generator's state, food, score, speed,
+ * direction and whether the snake is about to grow.
+ */
+struct CheckpointState {
+	std::uint64_t random_state;
+	std::uint64_t random_draws;
+	coordinates food;
+	std::uint32_t length;
+	std::uint16_t score;
+	std::uint16_t speed;
+	std::uint8_t direction;
+	std::uint8_t status;
+	std::uint8_t growing;
+};
+
+/*
+ * 		Checkpoint
+ *
+ * A live game mirrored into a small memory-mapped file, so it survives the
+ * process: a crash, a dropped SSH connection or a kill. Saving is a few
+ * stores into the mapping, no syscall; the page cache outlives the process
+ * and the kernel writes the pages back on its own (a kernel crash or power
+ * loss can lose the latest ticks).
+ *
+ * The file holds two slots written alternately, each under a sequence
+ * number that is odd while the slot is being written. A save cut short
+ * leaves its slot odd and the other one intact, so the newest even slot is
+ * always a complete game. An exclusive flock keeps a second SnakeGame from
+ * writing the same file.
+ */
+class Checkpoint {
+public:
+	Checkpoint() = default;
+
+	~Checkpoint() {
+		if (_map != MAP_FAILED) {
+			munmap(_map, _bytes);
+		}
+		if (_fd >= 0) {
+			close(_fd);
+		}
+	}
+
+	Checkpoint(const Checkpoint&) = delete;
+	Checkpoint& operator=(const Checkpoint&) = delete;
+
+	// Maps `path` for a width x height board, creating it if needed. A file
+	// for another board size is reset. False when it cannot be opened or
+	// another process holds it.
+	bool open(const char* path, unsigned short width, unsigned short height) noexcept {
+		_fd = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+		if (_fd < 0 || flock(_fd, LOCK_EX | LOCK_NB) != 0) {
+			return fail();
+		}
+		_capacity = static_cast<std::uint32_t>(width) * height;
+		_slot_bytes = (sizeof(Slot) + _capacity * sizeof(coordinates) + 63) / 64 * 64;
+		_bytes = sizeof(Header) + 2 * _slot_bytes;
+		struct stat status{};
+		if (fstat(_fd, &status) != 0 || (static_cast<size_t>(status.st_size) != _bytes && ftruncate(_fd, _bytes) != 0)) {
+			return fail();
+		}
+		_map = mmap(nullptr, _bytes, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+		if (_map == MAP_FAILED) {
+			return fail();
+		}
+
+		Header& header = *static_cast<Header*>(_map);
+		if (std::memcmp(header.magic, magic, sizeof(header.magic)) != 0 || header.width != width ||
+		    header.height != height) {
+			std::memset(_map, 0, _bytes);
+			std::memcpy(header.magic, magic, sizeof(header.magic));
+			header.width = width;
+			header.height = height;
+		}
+		// Carry on from whatever is in the file; a save cut short counts as
+		// the one before it, so the next save rewrites the torn slot and
+		// leaves the intact one alone
+		for (int i = 0; i < 2; ++i) {
+			std::uint64_t sequence = slot(i).sequence.load(std::memory_order_relaxed);
+			_sequence = std::max(_sequence, sequence & ~std::uint64_t{1});
+		}
+		return true;
+	}
+
+	bool is_open() const noexcept {
+		return _map != MAP_FAILED;
+	}
+
+	// Writes a new game state: fill(CheckpointState&, coordinates* body) sets
+	// the state and up to width x height body cells into the older slot
+	template <typename Fill>
+	void save(Fill&& fill) noexcept {
+		std::uint64_t next = _sequence + 2;
+		Slot& target = slot((next / 2) & 1);
+		target.sequence.store(next - 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		fill(target.state, body(target));
+		target.sequence.store(next, std::memory_order_release);
+		_sequence = next;
+	}
+
+	// The newest complete save; false when the file has none
+	bool latest(CheckpointState& state, const coordinates*& cells) const noexcept {
+		const Slot* newest = nullptr;
+		for (int i = 0; i < 2; ++i) {
+			const Slot& candidate = slot(i);
+			std::uint64_t sequence = candidate.sequence.load(std::memory_order_acquire);
+			if (sequence != 0 && (sequence & 1) == 0 &&
+			    (!newest || sequence > newest->sequence.load(std::memory_order_relaxed))) {
+				newest = &candidate;
+			}
+		}
+		if (!newest || newest->state.length == 0 || newest->state.length > _capacity) {
+			return false;
+		}
+		state = newest->state;
+		cells = body(const_cast<Slot&>(*newest));
+		return true;
+	}
+
+	std::uint32_t capacity() const noexcept {
+		return _capacity;
+	}
+
+private:
+	static constexpr char magic[8]{'S', 'N', 'A', 'K', 'E', 'C', 'P', '1'};
+
+	struct Header {
+		char magic[8];
+		std::uint16_t width;
+		std::uint16_t height;
+		char padding[52];
+	};
+
+	struct Slot {
+		std::atomic<std::uint64_t> sequence;	// odd while being written
+		CheckpointState state;
+	};
+
+	Slot& slot(int i) const noexcept {
+		return *reinterpret_cast<Slot*>(static_cast<char*>(_map) + sizeof(Header) + i * _slot_bytes);
+	}
+
+	// Body cells, head first, right after the slot's state
+	static coordinates* body(Slot& slot) noexcept {
+		return reinterpret_cast<coordinates*>(&slot + 1);
+	}
+
+	bool fail() noexcept {
+		if (_fd >= 0) {
+			close(_fd);
+			_fd = -1;
+		}
+		return false;
+	}
+
+	int _fd{-1};
+	void* _map{MAP_FAILED};
+	size_t _bytes{0};
+	size_t _slot_bytes{0};
+	std::uint32_t _capacity{0};
+	std::uint64_t _sequence{0};
+};
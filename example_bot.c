@@ -0,0 +1,88 @@
+/*
+ * 		Example bot plugin
+ *
+ * Heads for the food along the longer axis first and turns away from walls
+ * and its own body when it has to; no look-ahead. Built as a loadable
+ * module next to the executables:
+ *
+ *	SnakeBench --bot ./libsnake_example_bot.so
+ *
+ * Rebuild it while a bench or tournament is running and the next game
+ * picks up the new code.
+ */
+#include <stdlib.h>
+
+#include "snake_bot_api.h"
+
+static struct snake_cell step(struct snake_cell cell, int direction) {
+	switch (direction) {
+		case SNAKE_UP:
+			cell.y--;
+			break;
+		case SNAKE_RIGHT:
+			cell.x++;
+			break;
+		case SNAKE_DOWN:
+			cell.y++;
+			break;
+		default:
+			cell.x--;
+			break;
+	}
+	return cell;
+}
+
+/* Inside the walls and off the body; the tail moves away unless growing */
+static int is_free(const struct snake_board_view* view, struct snake_cell cell) {
+	unsigned int parts = view->growing ? view->length : view->length - 1;
+	if (cell.x == 0 || cell.y == 0 || cell.x >= view->width || cell.y >= view->height) {
+		return 0;
+	}
+	for (unsigned int i = 0; i < parts; ++i) {
+		if (view->body[i].x == cell.x && view->body[i].y == cell.y) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static int next_move(void* bot, const struct snake_board_view* view) {
+	struct snake_cell head = view->body[0];
+	int dx = (int)view->food.x - head.x;
+	int dy = (int)view->food.y - head.y;
+	int horizontal = dx > 0 ? SNAKE_RIGHT : SNAKE_LEFT;
+	int vertical = dy > 0 ? SNAKE_DOWN : SNAKE_UP;
+	int preferred[4];
+	int count = 0;
+	(void)bot;
+
+	if (abs(dx) >= abs(dy)) {
+		preferred[count++] = dx != 0 ? horizontal : vertical;
+		preferred[count++] = vertical;
+	} else {
+		preferred[count++] = vertical;
+		preferred[count++] = horizontal;
+	}
+	preferred[count++] = view->direction;
+	preferred[count++] = (view->direction + 1) % 4;
+	for (int i = 0; i < count; ++i) {
+		int direction = preferred[i];
+		if ((direction + 2) % 4 != view->direction && is_free(view, step(head, direction))) {
+			return direction;
+		}
+	}
+	return (view->direction + 3) % 4;
+}
+
+static const struct snake_bot_plugin plugin = {
+	SNAKE_BOT_API_VERSION,
+	"example",
+	NULL,
+	NULL,
+	NULL,
+	next_move
+};
+
+const struct snake_bot_plugin* snake_bot_plugin(void) {
+	return &plugin;
+}
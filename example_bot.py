@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+# Example external bot: reads rounds on stdin, answers moves on stdout, for
+# any number of games at once. Protocol in external_bot.h.
+#
+#	SnakeBench --bot "exec:python3 example_bot.py"
+
+import struct
+import sys
+
+UP, RIGHT, DOWN, LEFT = range(4)
+STEPS = {UP: (0, -1), RIGHT: (1, 0), DOWN: (0, 1), LEFT: (-1, 0)}
+
+
+def read(stream, size):
+    data = stream.read(size)
+    if len(data) < size:
+        sys.exit(0)
+    return data
+
+
+class Lane:
+    def __init__(self):
+        self.width = self.height = 0
+        self.body = []
+        self.food = (0, 0)
+        self.direction = RIGHT
+
+    def move(self):
+        head = self.body[0]
+        occupied = set(self.body[:-1])
+        best, best_distance = self.direction, None
+        for direction, (dx, dy) in STEPS.items():
+            if len(self.body) > 1 and direction == (self.direction + 2) % 4:
+                continue
+            x, y = head[0] + dx, head[1] + dy
+            if not (0 < x < self.width and 0 < y < self.height) or (x, y) in occupied:
+                continue
+            distance = abs(x - self.food[0]) + abs(y - self.food[1])
+            if best_distance is None or distance < best_distance:
+                best, best_distance = direction, distance
+        self.direction = best
+        return best
+
+
+def main():
+    stdin, stdout = sys.stdin.buffer, sys.stdout.buffer
+    _, version, lanes = struct.unpack("<cHH", read(stdin, 5))
+    games = [Lane() for _ in range(lanes)]
+    while True:
+        _, round_, count = struct.unpack("<cIH", read(stdin, 7))
+        ids = []
+        for _ in range(count):
+            lane_id, kind = struct.unpack("<Hc", read(stdin, 3))
+            lane = games[lane_id]
+            if kind == b"S":
+                (lane.width, lane.height, fx, fy, lane.direction, growing, score,
+                 length) = struct.unpack("<HHHHBBHI", read(stdin, 16))
+                cells = struct.unpack("<%dH" % (2 * length), read(stdin, 4 * length))
+                lane.body = list(zip(cells[0::2], cells[1::2]))
+            else:
+                hx, hy, fx, fy, flags = struct.unpack("<HHHHB", read(stdin, 9))
+                lane.body.insert(0, (hx, hy))
+                if not flags & 1:
+                    lane.body.pop()
+            lane.food = (fx, fy)
+            ids.append(lane_id)
+        reply = [struct.pack("<cIH", b"M", round_, len(ids))]
+        reply += [struct.pack("<HB", lane_id, games[lane_id].move()) for lane_id in ids]
+        stdout.write(b"".join(reply))
+        stdout.flush()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,390 @@
+#pragma once
+
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "types.h"
+#include "game.h"
+#include "bot.h"
+
+extern char** environ;
+
+/*
+ * 		ExternalBotProcess
+ *
+ * A bot in another process, in any language, talking a small binary
+ * protocol on its stdin and stdout. One process plays several games
+ * ("lanes") at once: every round carries the state of all of them in one
+ * write and takes all the moves back in one read, so the syscalls are
+ * shared by the whole batch.
+ *
+ * All integers are little-endian. The engine sends
+ *
+ *	'H' u16 version u16 lanes			once, at start
+ *	'T' u32 round u16 count, then count entries	every round, the first empty
+ *	    u16 lane 'S' u16 width u16 height u16 food_x u16 food_y
+ *	        u8 direction u8 growing u16 score u32 length, length x (u16 x u16 y)
+ *	    u16 lane 'D' u16 head_x u16 head_y u16 food_x u16 food_y u8 flags
+ *
+ * 'S' is the full state, sent when a lane starts a game; head first, cells
+ * with 0 < x < width and 0 < y < height are inside. 'D' is one tick: the
+ * new head, and the tail dropped unless flags bit 0 (grew) is set. Bit 1
+ * says the snake ate on that tick. The bot answers each round with
+ *
+ *	'M' u32 round u16 count, then count x (u16 lane u8 direction)
+ *
+ * with directions 0 up, 1 right, 2 down, 3 left. The answer must arrive
+ * within the deadline; otherwise the round's games keep their direction and
+ * a late answer is dropped when it comes. The empty first round is played
+ * at start with time for the bot to start up, so a command that fails to
+ * run or exits at once is caught before any game. A bot that breaks the
+ * protocol or exits keeps every game going straight from then on, and
+ * error() says what happened.
+ */
+class ExternalBotProcess {
+public:
+	struct Stats {
+		unsigned long long rounds{0};
+		unsigned long long moves{0};
+		unsigned long long timeouts{0};		// rounds answered late or not at all
+		unsigned long long bytes_sent{0};
+		unsigned long long bytes_received{0};
+		unsigned long long syscalls{0};		// writes, reads and polls
+	};
+
+	static constexpr std::uint16_t protocol_version{1};
+	static constexpr std::chrono::microseconds default_deadline{10000};
+
+	ExternalBotProcess(const std::string& command, size_t lanes, std::chrono::microseconds deadline,
+			   std::chrono::milliseconds startup = std::chrono::milliseconds{2000}) :
+		_lanes(lanes), _deadline(deadline), _startup(startup)
+	{
+		_out.reserve(64 + lanes * 16);
+		_in.reserve(64 + lanes * 3);
+		spawn(command);
+		if (_fd >= 0) {
+			put_u8('H');
+			put_u16(protocol_version);
+			put_u16(static_cast<std::uint16_t>(lanes));
+			next_moves(nullptr, 0, nullptr);
+			_stats = Stats{};
+		}
+	}
+
+	~ExternalBotProcess() {
+		stop();
+		if (_pid > 0) {
+			waitpid(_pid, nullptr, 0);
+		}
+	}
+
+	ExternalBotProcess(const ExternalBotProcess&) = delete;
+	ExternalBotProcess& operator=(const ExternalBotProcess&) = delete;
+
+	bool running() const noexcept {
+		return _fd >= 0;
+	}
+
+	// Why the bot stopped or never started; empty while it runs
+	const std::string& error() const noexcept {
+		return _error;
+	}
+
+	size_t lanes() const noexcept {
+		return _lanes.size();
+	}
+
+	const Stats& stats() const noexcept {
+		return _stats;
+	}
+
+	// The lane's game was restarted: its next round sends the full state
+	void on_game_start(size_t lane) noexcept {
+		_lanes[lane].synced = false;
+	}
+
+	// One round: moves[i] for games[i] on lane i, for the first `count` lanes;
+	// null games are idle lanes and left out. Games the bot does not answer
+	// for in time keep their direction.
+	void next_moves(const Game* const* games, size_t count, Direction* moves) noexcept {
+		size_t playing = 0;
+		for (size_t lane = 0; lane < count; ++lane) {
+			if (games[lane]) {
+				moves[lane] = games[lane]->snake().getDirection();
+				playing++;
+			}
+		}
+		_stats.rounds++;
+		if (_fd < 0) {
+			_stats.timeouts++;
+			return;
+		}
+		std::uint32_t round = ++_round;
+		put_u8('T');
+		put_u32(round);
+		put_u16(static_cast<std::uint16_t>(playing));
+		for (size_t lane = 0; lane < count; ++lane) {
+			if (games[lane]) {
+				encode(lane, *games[lane]);
+			}
+		}
+		if (!exchange(round, games, count, moves, round == 1 ? _startup : _deadline)) {
+			_stats.timeouts++;
+		}
+	}
+
+private:
+	struct Lane {
+		bool synced{false};
+		size_t length{0};
+		coordinates head;
+		unsigned short score{0};
+	};
+
+	void spawn(const std::string& command) {
+		int ends[2];
+		if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, ends) != 0) {
+			_error = std::string("socketpair: ") + std::strerror(errno);
+			return;
+		}
+		// A socket rather than two pipes: one fd each way, and MSG_NOSIGNAL instead of SIGPIPE
+		posix_spawn_file_actions_t actions;
+		posix_spawn_file_actions_init(&actions);
+		posix_spawn_file_actions_adddup2(&actions, ends[1], STDIN_FILENO);
+		posix_spawn_file_actions_adddup2(&actions, ends[1], STDOUT_FILENO);
+		const char* argv[] = {"/bin/sh", "-c", command.c_str(), nullptr};
+		int spawned = posix_spawn(&_pid, "/bin/sh", &actions, nullptr, const_cast<char**>(argv), environ);
+		if (spawned != 0) {
+			_error = std::string("cannot run /bin/sh: ") + std::strerror(spawned);
+			_pid = -1;
+			close(ends[0]);
+		} else {
+			_fd = ends[0];
+			fcntl(_fd, F_SETFL, O_NONBLOCK);
+		}
+		posix_spawn_file_actions_destroy(&actions);
+		close(ends[1]);
+	}
+
+	void stop() noexcept {
+		if (_fd >= 0) {
+			close(_fd);
+			_fd = -1;
+		}
+		if (_pid > 0) {
+			kill(_pid, SIGTERM);
+		}
+	}
+
+	// The bot is gone or unusable: stop it and keep why, with its exit status
+	// when it exited on its own rather than on our SIGTERM
+	void fail(const char* why) noexcept {
+		stop();
+		_error = why;
+		int status = 0;
+		if (_pid > 0 && waitpid(_pid, &status, 0) == _pid) {
+			_pid = -1;
+			if (WIFEXITED(status)) {
+				_error += " (exit status " + std::to_string(WEXITSTATUS(status)) + ")";
+			}
+		}
+	}
+
+	// Full state for a new or out-of-step game, else the one-tick delta
+	void encode(size_t index, const Game& game) noexcept {
+		Lane& lane = _lanes[index];
+		const auto& body = game.snake().body();
+		bool stepped = lane.synced && (body.size() == lane.length || body.size() == lane.length + 1) &&
+			       body.front() == next_cell(lane.head, game.snake().getDirection()) && game.score() >= lane.score;
+		put_u16(static_cast<std::uint16_t>(index));
+		if (stepped) {
+			std::uint8_t flags = (body.size() > lane.length ? 1 : 0) | (game.score() > lane.score ? 2 : 0);
+			put_u8('D');
+			put_cell(body.front());
+			put_cell(game.food());
+			put_u8(flags);
+		} else {
+			put_u8('S');
+			put_u16(game.get_width());
+			put_u16(game.get_height());
+			put_cell(game.food());
+			put_u8(game.snake().getDirection());
+			put_u8(game.snake().growing());
+			put_u16(game.score());
+			put_u32(static_cast<std::uint32_t>(body.size()));
+			for (const coordinates& part : body) {
+				put_cell(part);
+			}
+		}
+		lane.synced = true;
+		lane.length = body.size();
+		lane.head = body.front();
+		lane.score = game.score();
+	}
+
+	// Send the round, then read until its answer or the deadline
+	bool exchange(std::uint32_t round, const Game* const* games, size_t count, Direction* moves,
+		      std::chrono::microseconds timeout) noexcept {
+		auto deadline = std::chrono::steady_clock::now() + timeout;
+		size_t sent = 0;
+		while (true) {
+			if (sent < _out.size()) {
+				_stats.syscalls++;
+				ssize_t written = send(_fd, _out.data() + sent, _out.size() - sent, MSG_NOSIGNAL);
+				if (written < 0 && errno != EAGAIN) {
+					fail("closed its input");
+					return false;
+				}
+				sent += written > 0 ? written : 0;
+				_stats.bytes_sent += written > 0 ? written : 0;
+			}
+			int answered = parse(round, games, count, moves);
+			if (answered < 0) {
+				fail("broke the protocol");
+				return false;
+			}
+			// Unsent bytes stay queued in front of the next round
+			auto left = deadline - std::chrono::steady_clock::now();
+			if (answered > 0 || left <= std::chrono::steady_clock::duration::zero()) {
+				_out.erase(_out.begin(), _out.begin() + sent);
+				return answered > 0;
+			}
+			pollfd descriptor{_fd, static_cast<short>(POLLIN | (sent < _out.size() ? POLLOUT : 0)), 0};
+			timespec wait{0, static_cast<long>(std::chrono::duration_cast<std::chrono::nanoseconds>(left).count())};
+			if (wait.tv_nsec >= 1000000000L) {
+				wait.tv_sec = wait.tv_nsec / 1000000000L;
+				wait.tv_nsec %= 1000000000L;
+			}
+			_stats.syscalls++;
+			if (ppoll(&descriptor, 1, &wait, nullptr) <= 0 || !(descriptor.revents & (POLLIN | POLLHUP | POLLERR))) {
+				continue;
+			}
+			std::uint8_t chunk[4096];
+			_stats.syscalls++;
+			ssize_t received = recv(_fd, chunk, sizeof(chunk), 0);
+			if (received == 0 || (received < 0 && errno != EAGAIN)) {
+				fail("closed its output");
+				return false;
+			}
+			if (received > 0) {
+				_in.insert(_in.end(), chunk, chunk + received);
+				_stats.bytes_received += received;
+			}
+		}
+	}
+
+	// Consume whole answers from the input; 1 when this round's arrived,
+	// 0 when it has not yet, -1 on bytes that are not the protocol
+	int parse(std::uint32_t round, const Game* const* games, size_t count, Direction* moves) noexcept {
+		size_t at = 0;
+		int result = 0;
+		while (result == 0 && _in.size() - at >= 7) {
+			if (_in[at] != 'M') {
+				return -1;
+			}
+			std::uint32_t answer_round = get_u32(at + 1);
+			size_t entries = get_u16(at + 5);
+			size_t frame = 7 + entries * 3;
+			if (_in.size() - at < frame) {
+				break;
+			}
+			if (answer_round == round) {
+				for (size_t i = 0; i < entries; ++i) {
+					size_t lane = get_u16(at + 7 + i * 3);
+					std::uint8_t direction = _in[at + 7 + i * 3 + 2];
+					if (lane < count && games[lane] && direction <= Left) {
+						moves[lane] = static_cast<Direction>(direction);
+						_stats.moves++;
+					}
+				}
+				result = 1;
+			}
+			at += frame;
+		}
+		_in.erase(_in.begin(), _in.begin() + at);
+		return result;
+	}
+
+	void put_u8(std::uint8_t value) {
+		_out.push_back(value);
+	}
+
+	void put_u16(std::uint16_t value) {
+		_out.push_back(value & 0xff);
+		_out.push_back(value >> 8);
+	}
+
+	void put_u32(std::uint32_t value) {
+		put_u16(value & 0xffff);
+		put_u16(value >> 16);
+	}
+
+	void put_cell(coordinates cell) {
+		put_u16(cell.first);
+		put_u16(cell.second);
+	}
+
+	std::uint16_t get_u16(size_t at) const noexcept {
+		return _in[at] | _in[at + 1] << 8;
+	}
+
+	std::uint32_t get_u32(size_t at) const noexcept {
+		return get_u16(at) | static_cast<std::uint32_t>(get_u16(at + 2)) << 16;
+	}
+
+	int _fd{-1};
+	pid_t _pid{-1};
+	std::vector<Lane> _lanes;
+	std::chrono::microseconds _deadline;
+	std::chrono::milliseconds _startup;
+	std::uint32_t _round{0};
+	std::vector<std::uint8_t> _out;
+	std::vector<std::uint8_t> _in;
+	Stats _stats;
+	std::string _error;
+};
+
+/*
+ * 		ExternalBot
+ *
+ * One external process playing a single game through the Bot interface.
+ */
+class ExternalBot : public Bot {
+public:
+	ExternalBot(const std::string& command, std::chrono::microseconds deadline) :
+		_process(command, 1, deadline), _name("exec:" + command) {}
+
+	const char * name() const noexcept override {
+		return _name.c_str();
+	}
+
+	void on_game_start() noexcept override {
+		_process.on_game_start(0);
+	}
+
+	Direction next_move(const Game& game) noexcept override {
+		const Game* games[1] = {&game};
+		Direction move;
+		_process.next_moves(games, 1, &move);
+		return move;
+	}
+
+	const ExternalBotProcess& process() const noexcept {
+		return _process;
+	}
+
+private:
+	ExternalBotProcess _process;
+	std::string _name;
+};
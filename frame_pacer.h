@@ -0,0 +1,94 @@
+#pragma once
+
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <algorithm>
+#include <chrono>
+
+/*
+ * 		FramePacer
+ *
+ * Decides when the next frame may be drawn, based on how fast the terminal
+ * actually drains output. After every present it looks at the bytes still
+ * queued on the tty (TIOCOUTQ) and how long the write blocked; while the
+ * previous frame is not fully out, no new frame is drawn and the interval
+ * grows to the measured drain time, so the picture lags the simulation by
+ * one frame at most. On a constrained link screens should also switch to
+ * incremental updates (see incremental()).
+ */
+class FramePacer {
+public:
+	using clock = std::chrono::steady_clock;
+
+	static constexpr std::chrono::microseconds min_interval{1000000 / 60};
+	static constexpr std::chrono::microseconds max_interval{1000000};
+
+	explicit FramePacer(int fd) noexcept : _fd{fd} {}
+
+	bool frame_due(clock::time_point now) noexcept {
+		if (now - _last_frame < _interval) {
+			return false;
+		}
+		int queued = queued_bytes();
+		if (queued > 0) {
+			// Previous frame still on its way: stretch the interval to the time it takes to drain
+			auto since_present = std::chrono::duration_cast<std::chrono::microseconds>(now - _last_present);
+			int drained = _queued_after_present - queued;
+			if (drained > 0) {
+				_interval = std::chrono::microseconds{since_present.count() * _queued_after_present / drained};
+			} else {
+				_interval *= 2;
+			}
+			_interval = std::clamp(_interval, min_interval, max_interval);
+			return false;
+		}
+		// Link keeps up: ease back towards the full frame rate
+		_interval = std::max(min_interval, _interval * 7 / 8);
+		return true;
+	}
+
+	void on_frame(clock::time_point now) noexcept {
+		_last_frame = now;
+		_frame_pending = true;
+	}
+
+	// Call right after the frame was handed to the terminal; write_time is how long that took
+	void on_present(clock::time_point now, clock::duration write_time) noexcept {
+		if (!_frame_pending) {
+			return;
+		}
+		_frame_pending = false;
+		_last_present = now;
+		_queued_after_present = queued_bytes();
+		// A write that blocked for most of a frame means the kernel buffer is full
+		if (write_time > min_interval / 2) {
+			_interval = std::clamp(std::chrono::duration_cast<std::chrono::microseconds>(write_time * 2),
+					       min_interval, max_interval);
+		}
+	}
+
+	// Erase-and-diff instead of full repaints once the link is the bottleneck
+	bool incremental() const noexcept {
+		return _interval > min_interval;
+	}
+
+	std::chrono::microseconds interval() const noexcept {
+		return _interval;
+	}
+
+private:
+	int queued_bytes() const noexcept {
+		int queued = 0;
+		if (ioctl(_fd, TIOCOUTQ, &queued) != 0) {
+			return 0;
+		}
+		return queued;
+	}
+
+	int _fd;
+	std::chrono::microseconds _interval{min_interval};
+	clock::time_point _last_frame;
+	clock::time_point _last_present;
+	int _queued_after_present{0};
+	bool _frame_pending{false};
+};
@@ -0,0 +1,317 @@
+#pragma once
+
+#include <charconv>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "renderer.h"
+
+enum OutputStrategy {
+	FULL_REDRAW,	// home cursor, rewrite every row
+	ROW_DIFF,	// rewrite only rows that changed
+	CELL_DIFF	// rewrite only runs of changed cells (what ncurses aims for)
+};
+
+constexpr int output_strategies_count = 3;
+
+struct FrameStats {
+	unsigned long long frames{0};
+	unsigned long long bytes[output_strategies_count]{};
+};
+
+/*
+ * 		FramebufferRenderer
+ *
+ * Draws into a character grid instead of the terminal. Used headless by
+ * benchmarks and golden-frame comparisons; present() also records how many
+ * bytes each output strategy would have written to a real terminal.
+ */
+class FramebufferRenderer : public Renderer {
+public:
+	struct Cell {
+		char ch{' '};		// ASCII form, also used for glyph cells
+		Glyph glyph{NO_GLYPH};
+		bool highlighted{false};
+
+		bool operator==(const Cell& other) const noexcept {
+			return ch == other.ch && glyph == other.glyph && highlighted == other.highlighted;
+		}
+		bool operator!=(const Cell& other) const noexcept {
+			return !(*this == other);
+		}
+	};
+
+	FramebufferRenderer(unsigned short width, unsigned short height, const GlyphCache& glyphs = GlyphCache::unicode()) :
+		_glyphs{glyphs}, _width{width}, _height{height},
+		_front(static_cast<size_t>(width) * height), _back(_front.size()) {}
+
+	void clear_screen() noexcept override {
+		fill(0, 0, _width, _height);
+	}
+
+	void put(unsigned short y, unsigned short x, std::string_view text) noexcept override {
+		write(y, x, text, _highlighted, _width);
+	}
+
+	void put_glyph(unsigned short y, unsigned short x, Glyph glyph) noexcept override {
+		write_glyph(y, x, glyph, _highlighted);
+	}
+
+	void highlight(bool on) noexcept override {
+		_highlighted = on;
+	}
+
+	void draw_border() noexcept override {
+		frame(0, 0, _width, _height);
+	}
+
+	// Region primitives; callers drawing disjoint rectangles may run concurrently
+	void fill(unsigned short top, unsigned short left, unsigned short width, unsigned short height) noexcept {
+		for (unsigned short y = top; y < top + height && y < _height; ++y) {
+			std::fill(_front.begin() + index(y, left), _front.begin() + index(y, std::min<unsigned>(left + width, _width)), Cell{});
+		}
+	}
+
+	// Text is clipped at column 'limit'
+	void write(unsigned short y, unsigned short x, std::string_view text, bool highlighted, unsigned short limit) noexcept {
+		if (y >= _height) {
+			return;
+		}
+		limit = std::min(limit, _width);
+		for (char c : text) {
+			if (x >= limit) {
+				break;
+			}
+			_front[index(y, x++)] = Cell{c, NO_GLYPH, highlighted};
+		}
+	}
+
+	void write_glyph(unsigned short y, unsigned short x, Glyph glyph, bool highlighted) noexcept {
+		if (y < _height && x < _width) {
+			_front[index(y, x)] = Cell{_glyphs[glyph].ascii, glyph, highlighted};
+		}
+	}
+
+	void frame(unsigned short top, unsigned short left, unsigned short width, unsigned short height) noexcept {
+		unsigned short bottom = top + height - 1;
+		unsigned short right = left + width - 1;
+		for (unsigned short x = left + 1; x < right; ++x) {
+			write_glyph(top, x, GLYPH_WALL_HORIZONTAL, false);
+			write_glyph(bottom, x, GLYPH_WALL_HORIZONTAL, false);
+		}
+		for (unsigned short y = top + 1; y < bottom; ++y) {
+			write_glyph(y, left, GLYPH_WALL_VERTICAL, false);
+			write_glyph(y, right, GLYPH_WALL_VERTICAL, false);
+		}
+		write_glyph(top, left, GLYPH_CORNER_TOP_LEFT, false);
+		write_glyph(top, right, GLYPH_CORNER_TOP_RIGHT, false);
+		write_glyph(bottom, left, GLYPH_CORNER_BOTTOM_LEFT, false);
+		write_glyph(bottom, right, GLYPH_CORNER_BOTTOM_RIGHT, false);
+	}
+
+	void present() noexcept override {
+		if (_measure) {
+			// Only measuring needs the scratch buffer; reserved on the first frame so
+			// renderers that never measure (server sessions) don't carry it.
+			// Full redraw of a frame made of colored glyphs is the worst case.
+			if (_scratch.capacity() < _front.size() * 24) {
+				_scratch.reserve(_front.size() * 24);
+			}
+			for (int strategy = 0; strategy < output_strategies_count; ++strategy) {
+				_scratch.clear();
+				encode(static_cast<OutputStrategy>(strategy), _scratch);
+				_stats.bytes[strategy] += _scratch.size();
+			}
+		}
+		_stats.frames++;
+		_back = _front;
+	}
+
+	// Forget both frames, as after the terminal was cleared; keeps the buffers
+	void reset() noexcept {
+		std::fill(_front.begin(), _front.end(), Cell{});
+		std::fill(_back.begin(), _back.end(), Cell{});
+		_stats = FrameStats{};
+	}
+
+	// Append the escape sequences that would move the terminal from the last
+	// presented frame to the current one.
+	void encode(OutputStrategy strategy, std::string& out) const {
+		bool highlighted = false;
+		switch (strategy) {
+			case FULL_REDRAW:
+				out.append("\x1b[H");
+				for (unsigned short y = 0; y < _height; ++y) {
+					if (y != 0) {
+						out.append("\r\n");
+					}
+					encode_run(y, 0, _width, highlighted, out);
+				}
+				break;
+			case ROW_DIFF:
+				for (unsigned short y = 0; y < _height; ++y) {
+					if (!std::equal(_front.begin() + index(y, 0), _front.begin() + index(y, _width),
+							_back.begin() + index(y, 0))) {
+						encode_cursor(y, 0, out);
+						encode_run(y, 0, _width, highlighted, out);
+					}
+				}
+				break;
+			case CELL_DIFF:
+				for (unsigned short y = 0; y < _height; ++y) {
+					unsigned short x = 0;
+					while (x < _width) {
+						if (_front[index(y, x)] == _back[index(y, x)]) {
+							++x;
+							continue;
+						}
+						unsigned short end = x;
+						while (end < _width && _front[index(y, end)] != _back[index(y, end)]) {
+							++end;
+						}
+						encode_cursor(y, x, out);
+						encode_run(y, x, end, highlighted, out);
+						x = end;
+					}
+				}
+				break;
+			default:
+				break;
+		}
+		if (highlighted) {
+			out.append("\x1b[0m");
+		}
+	}
+
+	// Current grid as plain text, one line per row; used for golden frames
+	std::string to_string() const {
+		std::string text;
+		text.reserve(_front.size() + _height);
+		for (unsigned short y = 0; y < _height; ++y) {
+			for (unsigned short x = 0; x < _width; ++x) {
+				text.push_back(_front[index(y, x)].ch);
+			}
+			text.push_back('\n');
+		}
+		return text;
+	}
+
+	const Cell& cell(unsigned short y, unsigned short x) const noexcept {
+		return _front[index(y, x)];
+	}
+
+	void set_measure(bool measure) noexcept {
+		_measure = measure;
+	}
+
+	// Heap memory held by the frame buffers, on top of sizeof(FramebufferRenderer)
+	size_t heap_bytes() const noexcept {
+		return (_front.capacity() + _back.capacity()) * sizeof(Cell) + _scratch.capacity();
+	}
+
+	const FrameStats& stats() const noexcept {
+		return _stats;
+	}
+
+	unsigned short width() const noexcept {
+		return _width;
+	}
+
+	unsigned short height() const noexcept {
+		return _height;
+	}
+
+private:
+	size_t index(unsigned short y, unsigned short x) const noexcept {
+		return static_cast<size_t>(y) * _width + x;
+	}
+
+	static void encode_number(unsigned int value, std::string& out) {
+		char digits[8];
+		auto [end, error] = std::to_chars(digits, digits + sizeof(digits), value);
+		out.append(digits, end);
+	}
+
+	static void encode_cursor(unsigned short y, unsigned short x, std::string& out) {
+		out.append("\x1b[");
+		encode_number(y + 1, out);
+		out.push_back(';');
+		encode_number(x + 1, out);
+		out.push_back('H');
+	}
+
+	void encode_run(unsigned short y, unsigned short from, unsigned short to, bool& highlighted, std::string& out) const {
+		for (unsigned short x = from; x < to; ++x) {
+			const Cell& c = _front[index(y, x)];
+			if (c.highlighted != highlighted) {
+				out.append(c.highlighted ? "\x1b[7m" : "\x1b[0m");
+				highlighted = c.highlighted;
+			}
+			// Glyph bytes were encoded once by the cache; this is a plain copy
+			if (c.glyph != NO_GLYPH) {
+				out.append(_glyphs[c.glyph].escaped());
+			} else {
+				out.push_back(c.ch);
+			}
+		}
+	}
+
+	const GlyphCache& _glyphs;
+	unsigned short _width;
+	unsigned short _height;
+	bool _highlighted{false};
+	bool _measure{true};
+	std::vector<Cell> _front;
+	std::vector<Cell> _back;
+	std::string _scratch;
+	FrameStats _stats;
+};
+
+/*
+ * 		FramebufferRegion
+ *
+ * A rectangle of a shared framebuffer seen as a renderer of its own:
+ * coordinates are relative to the rectangle and drawing is clipped to it.
+ * present() is a no-op, the owner of the framebuffer presents once per frame.
+ */
+class FramebufferRegion : public Renderer {
+public:
+	FramebufferRegion(FramebufferRenderer& target, unsigned short top, unsigned short left,
+			  unsigned short width, unsigned short height) noexcept :
+		_target{target}, _top{top}, _left{left}, _width{width}, _height{height} {}
+
+	void clear_screen() noexcept override {
+		_target.fill(_top, _left, _width, _height);
+	}
+
+	void put(unsigned short y, unsigned short x, std::string_view text) noexcept override {
+		if (y < _height && x < _width) {
+			_target.write(_top + y, _left + x, text, _highlighted, _left + _width);
+		}
+	}
+
+	void put_glyph(unsigned short y, unsigned short x, Glyph glyph) noexcept override {
+		if (y < _height && x < _width) {
+			_target.write_glyph(_top + y, _left + x, glyph, _highlighted);
+		}
+	}
+
+	void highlight(bool on) noexcept override {
+		_highlighted = on;
+	}
+
+	void draw_border() noexcept override {
+		_target.frame(_top, _left, _width, _height);
+	}
+
+	void present() noexcept override {}
+
+private:
+	FramebufferRenderer& _target;
+	unsigned short _top;
+	unsigned short _left;
+	unsigned short _width;
+	unsigned short _height;
+	bool _highlighted{false};
+};
@@ -0,0 +1,418 @@
+#pragma once
+
+#include <ncurses.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+#include "types.h"
+#include "screen.h"
+#include "snake.h"
+#include "random_coordinates_generator.h"
+#include "tick_timer.h"
+#include "frame_pacer.h"
+#include "rewind_buffer.h"
+#include "checkpoint.h"
+#include "leaderboard.h"
+#include "trace.h"
+
+/*
+ * 		Game
+ */
+class Game : public Screen {
+public:
+	Game(unsigned short &width, unsigned short &height, Renderer &renderer) :
+		Game(width, height, renderer, std::random_device{}()) {}
+
+	Game(unsigned short &width, unsigned short &height, Renderer &renderer, unsigned int seed) :
+		Screen(width, height, renderer), _coords_generator(width, height, seed),
+		_snake{start_x, start_y, Right, static_cast<size_t>(width) * height}
+	{
+		generate_food();
+	}
+
+	void render() noexcept override {
+		clear_once();
+		switch (_game_status) {
+			case RUN:
+			{
+				if (!_timer) {
+					break;
+				}
+				if (_timer_interval != tick_interval()) {
+					_timer_interval = tick_interval();
+					_timer->start(_timer_interval);
+				}
+				auto ticks = std::min<std::uint64_t>(_timer->expirations(), max_catch_up_ticks);
+				if (ticks == 0) {
+					break;
+				}
+				for (; ticks != 0 && _game_status == RUN; --ticks) {
+					tick();
+				}
+				// Simulation may outrun the terminal; the pacer decides when it can take another frame
+				auto now = FramePacer::clock::now();
+				if (!_pacer || _pacer->frame_due(now) || _game_status != RUN) {
+					if (_pacer) {
+						_pacer->on_frame(now);
+					}
+					draw();
+				}
+				break;
+			}
+			case PAUSE:
+				stop_timer();
+				print_on_center("game paused, press p to unpause");
+				break;
+			case GAME_OVER:
+				stop_timer();
+				print_on_center("GAME OVER. Press r to restart or q to quit in menu");
+				break;
+			default:
+				break;
+		}
+	}
+
+	// Ticks come from this timer while the game is on screen
+	void attach_timer(TickTimer& timer) noexcept {
+		_timer = &timer;
+	}
+
+	void attach_pacer(FramePacer& pacer) noexcept {
+		_pacer = &pacer;
+	}
+
+	// Record every tick so the game can be rewound; 'b' goes back a second
+	void attach_rewind(RewindBuffer& rewind) noexcept {
+		_rewind = &rewind;
+		_rewind->clear();
+	}
+
+	// Mirror the game into `checkpoint` after every tick, to resume it after a crash
+	void attach_checkpoint(Checkpoint& checkpoint) noexcept {
+		_checkpoint = &checkpoint;
+	}
+
+	// Rank every game that ends on the host-wide leaderboard
+	void attach_leaderboard(Leaderboard& leaderboard) noexcept {
+		_leaderboard = &leaderboard;
+	}
+
+	// Continue the game saved in `checkpoint`, paused; false when it holds
+	// none that is still running on a board of this size
+	bool resume(const Checkpoint& checkpoint) {
+		CheckpointState state;
+		const coordinates* body = nullptr;
+		if (!checkpoint.latest(state, body) || state.status == GAME_OVER || state.direction > Left ||
+		    !is_inside(state.food, get_width(), get_height()) ||
+		    !std::all_of(body, body + state.length, [this](coordinates cell) {
+			    return is_inside(cell, get_width(), get_height());
+		    })) {
+			return false;
+		}
+		stop_timer();
+		_score = state.score;
+		_speed = state.speed;
+		_food = state.food;
+		_coords_generator.restore(state.random_state, state.random_draws);
+		_snake.assign(body, state.length, static_cast<Direction>(state.direction), state.growing);
+		_game_status = PAUSE;
+		_ranked = false;
+		if (_rewind) {
+			_rewind->clear();
+		}
+		return true;
+	}
+
+	// Write the current state to the attached checkpoint: one copy of the
+	// body into the mapped file, no syscall
+	void save_checkpoint() noexcept {
+		if (!_checkpoint) {
+			return;
+		}
+		_checkpoint->save([this](CheckpointState& state, coordinates* body) noexcept {
+			state.random_state = _coords_generator.state();
+			state.random_draws = _coords_generator.draws();
+			state.food = _food;
+			state.length = _snake.body().size();
+			state.score = _score;
+			state.speed = _speed;
+			state.direction = _snake.getDirection();
+			state.status = _game_status;
+			state.growing = _snake.growing();
+			std::copy(_snake.body().begin(), _snake.body().end(), body);
+		});
+	}
+
+	// Fixed tick rate up to 1000 ticks/sec instead of the score-driven speed; 0 turns it off
+	void set_turbo(unsigned int ticks_per_second) noexcept {
+		_turbo_rate = std::min(ticks_per_second, max_turbo_rate);
+		_turbo = _turbo_rate != 0;
+	}
+
+	std::chrono::microseconds tick_interval() const noexcept {
+		if (_turbo) {
+			return std::chrono::microseconds{1000000 / _turbo_rate};
+		}
+		return std::chrono::milliseconds{_speed};
+	}
+
+	// Advance the simulation by one step, without touching the screen
+	void tick() noexcept {
+		TraceSpan span("tick");
+		TickDelta delta{_snake.body().back(), _food, 0, static_cast<unsigned char>(_snake.getDirection()),
+				static_cast<unsigned char>(_game_status), _snake.growing(), false, false};
+		std::uint64_t draws = _coords_generator.draws();
+		{
+			TraceSpan move("move");
+			_snake.advance();
+		}
+
+		if (check_food()) {
+			_score++;
+			delta.ate = true;
+			delta.sped_up = _speed > 20;
+			_speed -= (_speed > 20) ? 5 : 0;
+			_snake.grow_up();
+			generate_food();
+			delta.draws = _coords_generator.draws() - draws;
+		}
+
+		bool collided;
+		{
+			TraceSpan collision("collision");
+			collided = check_collision() || _snake.check_self_abuse();
+		}
+		if (collided) {
+			_game_status = GAME_OVER;
+			// A game rewound past its end and lost again is ranked once
+			if (_leaderboard && !_ranked) {
+				_leaderboard->record(_score, get_width(), get_height());
+				_ranked = true;
+			}
+		}
+		if (_rewind) {
+			_rewind->push(delta);
+		}
+		{
+			TraceSpan checkpoint("checkpoint");
+			save_checkpoint();
+		}
+	}
+
+	// Undo up to `ticks` recorded ticks, latest first; returns how many were undone
+	size_t rewind(size_t ticks) noexcept {
+		size_t undone = 0;
+		TickDelta delta;
+		for (; undone < ticks && _rewind && _rewind->pop(delta); ++undone) {
+			if (delta.ate) {
+				_score--;
+				_speed += delta.sped_up ? 5 : 0;
+				_coords_generator.backtrack(delta.draws);
+			}
+			_food = delta.food;
+			_snake.retreat(delta.tail, delta.grew, static_cast<Direction>(delta.direction));
+			_game_status = static_cast<GameStatus>(delta.status);
+		}
+		if (undone != 0) {
+			save_checkpoint();
+		}
+		return undone;
+	}
+
+	// Place food on a random cell not covered by the snake
+	void generate_food() {
+		TraceSpan span("generate_food");
+		_food =  _coords_generator.get();
+		while (_snake.is_part_of_body(_food)) {
+			_food = _coords_generator.get();
+		}
+	}
+
+	// Paint the current state of the board
+	void draw() noexcept {
+		TraceSpan span("draw");
+		renderer().clear_screen();
+		_snake.draw(renderer());
+
+		draw_food_trace();
+		draw_score();
+		draw_food();
+		if (_turbo && _timer) {
+			draw_jitter();
+		}
+	}
+
+	void input_handler(int input, AppStatus& status) noexcept override {
+		switch (input) {
+			case KEY_UP:
+				turn(Up);
+				break;
+			case KEY_RIGHT:
+				turn(Right);
+				break;
+			case KEY_DOWN:
+				turn(Down);
+				break;
+			case KEY_LEFT:
+				turn(Left);
+				break;
+			case 'q':
+				stop_timer();
+				on_leave();
+				status = MENU;
+				break;
+			case 't':
+				_turbo = !_turbo && _turbo_rate != 0;
+				break;
+			case 'p':
+				_game_status = (_game_status == PAUSE) ? RUN : PAUSE;
+				break;
+			case 'r':
+				restart();
+				_game_status = PAUSE;
+				break;
+			case 'b':
+				if (rewind(std::chrono::seconds{1} / tick_interval()) != 0) {
+					draw();
+					_game_status = PAUSE;
+				}
+				break;
+			default:
+				break;
+		}
+	}
+
+	// Start over as if freshly constructed, reusing every buffer: no allocation.
+	// Without a seed the food sequence simply continues.
+	void restart() noexcept {
+		stop_timer();
+		on_leave();
+		_snake.reset(start_x, start_y, Right);
+		_score = 0;
+		_speed = initial_speed;
+		_game_status = RUN;
+		_ranked = false;
+		generate_food();
+		if (_rewind) {
+			_rewind->clear();
+		}
+		save_checkpoint();
+	}
+
+	void restart(unsigned int seed) noexcept {
+		_coords_generator.seed(seed);
+		restart();
+	}
+
+	// Copy another game's simulation state (same board size), reusing this
+	// game's buffers; timer, pacer and turbo settings stay as they are
+	void load_state(const Game& other) noexcept {
+		_speed = other._speed;
+		_score = other._score;
+		_food = other._food;
+		_coords_generator = other._coords_generator;
+		_snake = other._snake;
+		_game_status = other._game_status;
+	}
+
+	// Cells off the border; anything else is a collision
+	static bool is_inside(coordinates cell, unsigned short width, unsigned short height) noexcept {
+		return cell.first > 0 && cell.second > 0 && cell.first < width && cell.second < height;
+	}
+
+	// Change direction unless it would reverse the snake into itself
+	void turn(Direction direction) noexcept {
+		if (direction != opposite(_snake.getDirection())) {
+			_snake.setDirection(direction);
+		}
+	}
+
+	GameStatus status() const noexcept {
+		return _game_status;
+	}
+
+	unsigned short score() const noexcept {
+		return _score;
+	}
+
+	const Snake & snake() const noexcept {
+		return _snake;
+	}
+
+	coordinates food() const noexcept {
+		return _food;
+	}
+
+	// Heap memory held by this game (the snake body), on top of sizeof(Game)
+	size_t heap_bytes() const noexcept {
+		return _snake.body().capacity() * sizeof(coordinates);
+	}
+
+private:
+	bool check_collision() {
+		return !is_inside(_snake.getHead(), get_width(), get_height());
+	}
+
+	void draw_food() {
+		renderer().put_glyph(_food.second, _food.first, GLYPH_FOOD);
+	}
+
+	bool check_food() {
+		return _food == _snake.getHead();
+	}
+
+	void draw_score() {
+		char line[16];
+		int size = std::snprintf(line, sizeof(line), "score %d", _score);
+		renderer().put(1, get_width() / 2, std::string_view(line, size));
+	}
+
+	void draw_food_trace() {
+		char line[16];
+		int size = std::snprintf(line, sizeof(line), "x: %d", _food.first);
+		renderer().put(1, 2, std::string_view(line, size));
+		size = std::snprintf(line, sizeof(line), "y: %d", _food.second);
+		renderer().put(2, 2, std::string_view(line, size));
+	}
+
+	void draw_jitter() {
+		const TickTimer::Jitter& jitter = _timer->jitter();
+		char line[80];
+		int size = std::snprintf(line, sizeof(line), "turbo %u t/s  jitter p50 %lldus p99 %lldus max %lldus",
+					 _turbo_rate, static_cast<long long>(jitter.percentile(0.5).count()),
+					 static_cast<long long>(jitter.percentile(0.99).count()),
+					 static_cast<long long>(jitter.max.count()));
+		renderer().put(get_height() - 2, 2, std::string_view(line, std::min<int>(size, sizeof(line) - 1)));
+	}
+
+	void stop_timer() noexcept {
+		if (_timer && _timer_interval.count() != 0) {
+			_timer->stop();
+			_timer_interval = std::chrono::microseconds{0};
+		}
+	}
+
+	static constexpr unsigned short start_x{10};
+	static constexpr unsigned short start_y{10};
+	static constexpr unsigned short initial_speed{150};
+	static constexpr unsigned int max_turbo_rate{1000};
+	static constexpr std::uint64_t max_catch_up_ticks{100};
+
+	unsigned short _speed{initial_speed};
+	unsigned short _score{0};
+	TickTimer* _timer{nullptr};
+	std::chrono::microseconds _timer_interval{0};
+	FramePacer* _pacer{nullptr};
+	RewindBuffer* _rewind{nullptr};
+	Checkpoint* _checkpoint{nullptr};
+	Leaderboard* _leaderboard{nullptr};
+	bool _ranked{false};
+	unsigned int _turbo_rate{0};
+	bool _turbo{false};
+	coordinates _food;
+	RandomCoordinatesGenerator _coords_generator;
+	Snake _snake;
+	GameStatus _game_status{RUN};
+};
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <langinfo.h>
+#include <array>
+#include <cstring>
+#include <string_view>
+
+enum Glyph : unsigned char {
+	NO_GLYPH,
+	GLYPH_HEAD_UP,
+	GLYPH_HEAD_RIGHT,
+	GLYPH_HEAD_DOWN,
+	GLYPH_HEAD_LEFT,
+	GLYPH_BODY,
+	GLYPH_FOOD,
+	GLYPH_WALL_HORIZONTAL,
+	GLYPH_WALL_VERTICAL,
+	GLYPH_CORNER_TOP_LEFT,
+	GLYPH_CORNER_TOP_RIGHT,
+	GLYPH_CORNER_BOTTOM_LEFT,
+	GLYPH_CORNER_BOTTOM_RIGHT,
+	GLYPHS_COUNT
+};
+
+// Color pairs registered with ncurses for glyphs; pair 1 is the menu highlight
+enum GlyphColor : short {
+	NO_COLOR_PAIR,
+	HEAD_COLOR_PAIR = 2,
+	BODY_COLOR_PAIR,
+	FOOD_COLOR_PAIR
+};
+
+/*
+ * 		GlyphCache
+ *
+ * Every kind of board cell encoded once up front: the plain text ncurses
+ * prints, the exact bytes (color escape + UTF-8 + color reset) a raw
+ * terminal writer copies, and an ASCII stand-in for text dumps.
+ */
+class GlyphCache {
+public:
+	struct Encoded {
+		char bytes[24];
+		unsigned char size;
+		unsigned char text_size;	// plain text is the middle of bytes, after the color escape
+		unsigned char text_offset;
+		char ascii;
+		short color_pair;
+
+		std::string_view escaped() const noexcept {
+			return {bytes, size};
+		}
+
+		std::string_view text() const noexcept {
+			return {bytes + text_offset, text_size};
+		}
+	};
+
+	static const GlyphCache& ascii() {
+		static const GlyphCache cache(false);
+		return cache;
+	}
+
+	static const GlyphCache& unicode() {
+		static const GlyphCache cache(true);
+		return cache;
+	}
+
+	// Unicode glyphs when the current locale can print them
+	static const GlyphCache& for_locale() {
+		return std::strcmp(nl_langinfo(CODESET), "UTF-8") == 0 ? unicode() : ascii();
+	}
+
+	const Encoded& operator[](Glyph glyph) const noexcept {
+		return _glyphs[glyph];
+	}
+
+private:
+	explicit GlyphCache(bool unicode) {
+		encode(GLYPH_HEAD_UP, unicode ? "▲" : "@", '@', "\x1b[33m", HEAD_COLOR_PAIR);
+		encode(GLYPH_HEAD_RIGHT, unicode ? "▶" : "@", '@', "\x1b[33m", HEAD_COLOR_PAIR);
+		encode(GLYPH_HEAD_DOWN, unicode ? "▼" : "@", '@', "\x1b[33m", HEAD_COLOR_PAIR);
+		encode(GLYPH_HEAD_LEFT, unicode ? "◀" : "@", '@', "\x1b[33m", HEAD_COLOR_PAIR);
+		encode(GLYPH_BODY, unicode ? "█" : "@", '@', "\x1b[32m", BODY_COLOR_PAIR);
+		encode(GLYPH_FOOD, unicode ? "◆" : "$", '$', "\x1b[31m", FOOD_COLOR_PAIR);
+		encode(GLYPH_WALL_HORIZONTAL, unicode ? "─" : "-", '-', "", NO_COLOR_PAIR);
+		encode(GLYPH_WALL_VERTICAL, unicode ? "│" : "|", '|', "", NO_COLOR_PAIR);
+		encode(GLYPH_CORNER_TOP_LEFT, unicode ? "┌" : "+", '+', "", NO_COLOR_PAIR);
+		encode(GLYPH_CORNER_TOP_RIGHT, unicode ? "┐" : "+", '+', "", NO_COLOR_PAIR);
+		encode(GLYPH_CORNER_BOTTOM_LEFT, unicode ? "└" : "+", '+', "", NO_COLOR_PAIR);
+		encode(GLYPH_CORNER_BOTTOM_RIGHT, unicode ? "┘" : "+", '+', "", NO_COLOR_PAIR);
+	}
+
+	void encode(Glyph glyph, std::string_view text, char ascii, std::string_view color, short color_pair) {
+		Encoded& encoded = _glyphs[glyph];
+		std::string_view reset = color.empty() ? "" : "\x1b[39m";
+		std::memcpy(encoded.bytes, color.data(), color.size());
+		std::memcpy(encoded.bytes + color.size(), text.data(), text.size());
+		std::memcpy(encoded.bytes + color.size() + text.size(), reset.data(), reset.size());
+		encoded.size = color.size() + text.size() + reset.size();
+		encoded.text_offset = color.size();
+		encoded.text_size = text.size();
+		encoded.ascii = ascii;
+		encoded.color_pair = color_pair;
+	}
+
+	std::array<Encoded, GLYPHS_COUNT> _glyphs{};
+};
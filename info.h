@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdio>
+
+#include "screen.h"
+#include "leaderboard.h"
+
+/*
+ * 		Info
+ *
+ * With a leaderboard attached, shows the best scores on the host: overall
+ * on the left, for this board size on the right. The tables are read
+ * without locking and redrawn only when the sequence says they changed.
+ */
+class Info : public Screen {
+public:
+	Info(unsigned short &width, unsigned short &height, Renderer &renderer) : Screen(width, height, renderer) {}
+
+	void attach_leaderboard(const Leaderboard& leaderboard) noexcept {
+		_leaderboard = &leaderboard;
+	}
+
+	void render() noexcept override {
+		clear_once();
+		if (!_leaderboard) {
+			print_on_center("print q to back in menu");
+			return;
+		}
+		std::uint64_t sequence = _leaderboard->sequence();
+		if (_drawn && sequence == _shown_sequence) {
+			return;
+		}
+		if (_leaderboard->snapshot(_tables, sequence)) {
+			draw_leaderboard(sequence);
+		}
+	}
+
+	void input_handler(int input, AppStatus& status) noexcept override {
+		switch (input) {
+			case 'q':
+				on_leave();
+				_drawn = false;
+				status = MENU;
+				break;
+			default:
+				break;
+		}
+	}
+
+private:
+	void draw_leaderboard(std::uint64_t sequence) noexcept {
+		renderer().clear_screen();
+		unsigned short column = get_width() / 2;
+		char line[64];
+		int size = std::snprintf(line, sizeof(line), "%ux%u", get_width(), get_height());
+		draw_table(2, "all boards", _tables.overall, true);
+		const LeaderboardTable* board = _tables.board(get_width(), get_height());
+		if (board && column >= 32) {
+			draw_table(column, std::string_view(line, size), *board, false);
+		}
+		print_on_bottom("print q to back in menu");
+		_shown_sequence = sequence;
+		_drawn = true;
+	}
+
+	void draw_table(unsigned short column, std::string_view title, const LeaderboardTable& table, bool with_board) noexcept {
+		renderer().put(2, column, title);
+		if (table.count == 0) {
+			renderer().put(4, column, "no games yet");
+		}
+		char line[64];
+		for (std::uint32_t i = 0; i < table.count && 4 + i < get_height() - 2u; ++i) {
+			const LeaderboardEntry& entry = table.entries[i];
+			int size = with_board ?
+				std::snprintf(line, sizeof(line), "%2u. %-12.12s %5u  %ux%u", i + 1, entry.name, entry.score, entry.width, entry.height) :
+				std::snprintf(line, sizeof(line), "%2u. %-12.12s %5u", i + 1, entry.name, entry.score);
+			renderer().put(4 + i, column, std::string_view(line, std::min<int>(size, sizeof(line) - 1)));
+		}
+	}
+
+	void print_on_bottom(std::string_view msg) noexcept {
+		renderer().put(get_height() - 2, (get_width() / 2) - (msg.size() / 2), msg);
+	}
+
+	const Leaderboard* _leaderboard{nullptr};
+	LeaderboardTables _tables;
+	std::uint64_t _shown_sequence{0};
+	bool _drawn{false};
+};
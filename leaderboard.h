@@ -0,0 +1,311 @@
+#pragma once
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+/*
+ * 		LeaderboardEntry
+ */
+struct LeaderboardEntry {
+	std::int64_t time;	// seconds since the epoch
+	std::uint16_t score;
+	std::uint16_t width;
+	std::uint16_t height;
+	char name[18];
+};
+
+/*
+ * 		LeaderboardTable
+ *
+ * Best scores first; among equal scores the earlier game stays ahead.
+ */
+struct LeaderboardTable {
+	static constexpr std::uint32_t max_entries{10};
+
+	// Board size this table ranks; 0x0 for the overall table
+	std::uint16_t width;
+	std::uint16_t height;
+	std::uint32_t count;
+	LeaderboardEntry entries[max_entries];
+
+	void insert(const LeaderboardEntry& entry) noexcept {
+		count = std::min(count, max_entries);
+		std::uint32_t position = 0;
+		while (position < count && entries[position].score >= entry.score) {
+			position++;
+		}
+		if (position == max_entries) {
+			return;
+		}
+		count = std::min(count + 1, max_entries);
+		std::copy_backward(entries + position, entries + count - 1, entries + count);
+		entries[position] = entry;
+	}
+
+	bool qualifies(std::uint16_t score) const noexcept {
+		return count < max_entries || score > entries[max_entries - 1].score;
+	}
+};
+
+/*
+ * 		LeaderboardTables
+ *
+ * The top scores overall and for up to max_boards board sizes. Once all
+ * are taken, a new size replaces the one with the lowest best score, and
+ * only with a game that beats that score.
+ */
+struct LeaderboardTables {
+	static constexpr size_t max_boards{16};
+
+	LeaderboardTable overall;
+	LeaderboardTable boards[max_boards];
+
+	const LeaderboardTable* board(unsigned short width, unsigned short height) const noexcept {
+		for (const LeaderboardTable& table : boards) {
+			if (table.count != 0 && table.width == width && table.height == height) {
+				return &table;
+			}
+		}
+		return nullptr;
+	}
+};
+
+/*
+ * 		Leaderboard
+ *
+ * High scores shared by every SnakeGame on the host through a memory-mapped
+ * file. Writers, one per finished game, serialize on a process-shared
+ * robust mutex: a process that dies holding it hands the next writer
+ * EOWNERDEAD instead of a deadlock, and that writer repairs the tables.
+ *
+ * Readers never take the mutex. Writers bump a sequence number to odd
+ * before touching the tables and back to even after, so a reader copies
+ * the tables and keeps the copy only when the sequence was even and
+ * unchanged around it (a seqlock).
+ *
+ * Anyone on the host can write the file, lock word included, and a holder
+ * that is stopped rather than dead never lets go. So a writer waits at
+ * most max_lock_wait for the mutex and leaves the game unranked when it
+ * does not get it, and open() gives up rather than wait for the file
+ * lock: a game's loop is delayed by at most max_lock_wait at game over.
+ */
+class Leaderboard {
+public:
+	Leaderboard() = default;
+
+	~Leaderboard() {
+		if (_shared) {
+			munmap(_shared, sizeof(Shared));
+		}
+	}
+
+	Leaderboard(const Leaderboard&) = delete;
+	Leaderboard& operator=(const Leaderboard&) = delete;
+
+	// Maps the shared file at `path`, creating it writable by every user on
+	// first use. False when it cannot be opened or another process holds its
+	// lock; the game then runs without a leaderboard.
+	bool open(const char* path) noexcept {
+		int fd = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+		if (fd < 0) {
+			return false;
+		}
+		// The first process to get here lays out the file; flock only guards that
+		if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+			close(fd);
+			return false;
+		}
+		struct stat status{};
+		bool ready = fstat(fd, &status) == 0;
+		if (ready && static_cast<size_t>(status.st_size) < sizeof(Shared)) {
+			fchmod(fd, 0666);
+			ready = ftruncate(fd, sizeof(Shared)) == 0;
+		}
+		void* map = ready ? mmap(nullptr, sizeof(Shared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+		if (map != MAP_FAILED) {
+			_shared = static_cast<Shared*>(map);
+			if (std::memcmp(_shared->magic, magic, sizeof(magic)) != 0) {
+				initialize();
+			}
+		}
+		flock(fd, LOCK_UN);
+		close(fd);
+
+		const char* user = std::getenv("USER");
+		std::strncpy(_name, user && *user ? user : "?", sizeof(_name) - 1);
+		return _shared != nullptr;
+	}
+
+	bool is_open() const noexcept {
+		return _shared != nullptr;
+	}
+
+	// Ranks a finished game under the writers' mutex; the tables change only
+	// when the score makes one of them. Skipped when the mutex stays taken
+	// for max_lock_wait.
+	void record(std::uint16_t score, unsigned short width, unsigned short height) noexcept {
+		if (!_shared || score == 0) {
+			return;
+		}
+		LeaderboardEntry entry{static_cast<std::int64_t>(std::time(nullptr)), score, width, height, {}};
+		std::memcpy(entry.name, _name, sizeof(entry.name));
+
+		timespec until{};
+		clock_gettime(CLOCK_REALTIME, &until);
+		until.tv_nsec += std::chrono::nanoseconds(max_lock_wait).count();
+		if (until.tv_nsec >= 1000000000L) {
+			until.tv_sec++;
+			until.tv_nsec -= 1000000000L;
+		}
+		int locked = pthread_mutex_timedlock(&_shared->mutex, &until);
+		if (locked == EOWNERDEAD) {
+			repair();
+			pthread_mutex_consistent(&_shared->mutex);
+		} else if (locked != 0) {
+			return;
+		}
+		LeaderboardTables& tables = _shared->tables;
+		LeaderboardTable* board = board_for(width, height, score);
+		if (tables.overall.qualifies(score) || (board && board->qualifies(score))) {
+			std::uint64_t sequence = _shared->sequence.load(std::memory_order_relaxed);
+			_shared->sequence.store(sequence + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			tables.overall.insert(entry);
+			if (board) {
+				if (board->width != width || board->height != height) {
+					*board = LeaderboardTable{width, height, 0, {}};
+				}
+				board->insert(entry);
+			}
+			_shared->sequence.store(sequence + 2, std::memory_order_release);
+		}
+		pthread_mutex_unlock(&_shared->mutex);
+	}
+
+	// Bumped by every change; cheap to poll before taking a snapshot
+	std::uint64_t sequence() const noexcept {
+		return _shared ? _shared->sequence.load(std::memory_order_acquire) : 0;
+	}
+
+	// Consistent copy of the tables without blocking; false if writers kept
+	// changing them for the whole attempt
+	bool snapshot(LeaderboardTables& tables, std::uint64_t& sequence) const noexcept {
+		if (!_shared) {
+			return false;
+		}
+		if (read(tables, sequence)) {
+			return true;
+		}
+		// A sequence that stays odd with the mutex free belongs to a dead writer: clean up after it
+		int locked = pthread_mutex_trylock(&_shared->mutex);
+		if (locked != 0 && locked != EOWNERDEAD) {
+			return false;
+		}
+		repair();
+		if (locked == EOWNERDEAD) {
+			pthread_mutex_consistent(&_shared->mutex);
+		}
+		pthread_mutex_unlock(&_shared->mutex);
+		return read(tables, sequence);
+	}
+
+private:
+	static constexpr char magic[8]{'S', 'N', 'A', 'K', 'E', 'L', 'B', '1'};
+	static constexpr int max_read_attempts{64};
+	// Far longer than any writer holds the mutex, short enough to go unnoticed at game over
+	static constexpr std::chrono::milliseconds max_lock_wait{2};
+
+	struct Shared {
+		char magic[8];
+		pthread_mutex_t mutex;
+		std::atomic<std::uint64_t> sequence;	// odd while a writer is changing the tables
+		LeaderboardTables tables;
+	};
+
+	bool read(LeaderboardTables& tables, std::uint64_t& sequence) const noexcept {
+		for (int attempt = 0; attempt < max_read_attempts; ++attempt) {
+			std::uint64_t before = _shared->sequence.load(std::memory_order_acquire);
+			if (before & 1) {
+				sched_yield();
+				continue;
+			}
+			std::memcpy(&tables, &_shared->tables, sizeof(tables));
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (_shared->sequence.load(std::memory_order_relaxed) == before) {
+				// Anyone can write the file: never trust its counts
+				tables.overall.count = std::min(tables.overall.count, LeaderboardTable::max_entries);
+				for (LeaderboardTable& table : tables.boards) {
+					table.count = std::min(table.count, LeaderboardTable::max_entries);
+				}
+				sequence = before;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Under the file lock, on a new or foreign file
+	void initialize() noexcept {
+		std::memset(static_cast<void*>(_shared), 0, sizeof(Shared));
+		pthread_mutexattr_t attributes;
+		pthread_mutexattr_init(&attributes);
+		pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+		pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+		pthread_mutex_init(&_shared->mutex, &attributes);
+		pthread_mutexattr_destroy(&attributes);
+		std::atomic_thread_fence(std::memory_order_release);
+		std::memcpy(_shared->magic, magic, sizeof(magic));
+	}
+
+	// A writer died mid-update: re-sort what it left and close its sequence
+	void repair() const noexcept {
+		auto fix = [](LeaderboardTable& table) {
+			table.count = std::min(table.count, LeaderboardTable::max_entries);
+			std::stable_sort(table.entries, table.entries + table.count,
+					 [](const LeaderboardEntry& a, const LeaderboardEntry& b) {
+						 return a.score > b.score;
+					 });
+		};
+		fix(_shared->tables.overall);
+		for (LeaderboardTable& table : _shared->tables.boards) {
+			fix(table);
+		}
+		std::uint64_t sequence = _shared->sequence.load(std::memory_order_relaxed);
+		_shared->sequence.store(sequence + (sequence & 1), std::memory_order_release);
+	}
+
+	// The table for this board size, else a free one, else the one with the
+	// lowest best score if this game beats it; nullptr when none qualifies
+	LeaderboardTable* board_for(unsigned short width, unsigned short height, std::uint16_t score) noexcept {
+		LeaderboardTable* free = nullptr;
+		LeaderboardTable* weakest = nullptr;
+		for (LeaderboardTable& table : _shared->tables.boards) {
+			if (table.count == 0) {
+				free = free ? free : &table;
+			} else if (table.width == width && table.height == height) {
+				return &table;
+			} else if (!weakest || table.entries[0].score < weakest->entries[0].score) {
+				weakest = &table;
+			}
+		}
+		if (free) {
+			return free;
+		}
+		return score > weakest->entries[0].score ? weakest : nullptr;
+	}
+
+	Shared* _shared{nullptr};
+	char _name[18]{};
+};
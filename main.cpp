@@ -1,430 +1,59 @@
 #include <ncurses.h>
-#include <random>
-#include <array>
-#include <string>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <clocale>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <memory>
-#include <chrono>
-#include <string_view>
-#include <algorithm>
-
-// local namespace
-namespace {
-
-enum AppStatus {
-	MENU,
-	GAME,
-	INFO,
-	EXIT
-};
-
-enum GameStatus {
-	RUN,
-	PAUSE,
-	GAME_OVER
-};
-
-// In this style 'cause ncurse already has function 'UP'
-enum Direction {
-	Up,
-	Right,
-	Down,
-	Left
-};
-
-typedef std::pair<unsigned short, unsigned short> coordinates;	// first = x; second = y;
-
-} // local namespace
-
-/*
- * 		RandomCoordinatesGenerator
- */
-class RandomCoordinatesGenerator {
-public:
-	RandomCoordinatesGenerator(unsigned short width, unsigned short height) noexcept :
-		_w_distribution(1, width - 1), _h_distribution(1, height - 1)
-	{
-		std::random_device random_device;
-		_random_generator = std::mt19937(random_device());
-	}
-
-	coordinates get() noexcept {
-		return {
-			_w_distribution(_random_generator),
-			_h_distribution(_random_generator)
-		};
-	};
-private:
-	std::mt19937 _random_generator;
-	std::uniform_int_distribution<unsigned short> _w_distribution;
-	std::uniform_int_distribution<unsigned short> _h_distribution;
-};
-
-/*
- * 		Snake
- */
-
-class Snake {
-public:
-	Snake(unsigned short init_x, unsigned short init_y, Direction direction) : _direction{direction} {
-		_body_parts.reserve(100);
-		_body_parts.emplace_back(init_x, init_y);
-	}
-
-	void setDirection(Direction direction) noexcept {
-		_direction = direction;
-	}
-
-	const Direction & getDirection() const {
-		return _direction;
-	}
-
-	void reset() noexcept {
-		_body_parts.resize(1);
-	}
-
-	void init(unsigned short init_x, unsigned short init_y) {
-		_body_parts.emplace_back(init_x, init_y);
-	}
-
-	void render() noexcept {
-		clear();
-		move_body();
-		draw_body();
-	}
-
-	coordinates getHead() const noexcept {
-		return _body_parts[0];
-	};
-
-	void grow_up() noexcept {
-		_will_be_grown = true;
-	}
-
-	bool is_part_of_body(const coordinates& coords) {
-		return std::any_of(_body_parts.cbegin(), _body_parts.cend(),
-				   [&coords](const coordinates& part) {
-					   return part == coords;
-				   }
-		);
-	}
-
-	bool check_self_abuse() {
-		return std::any_of(_body_parts.cbegin() + 1, _body_parts.cend(),
-				   [this](const coordinates& part) {
-					   return part == _body_parts.front();
-				   }
-		);
-	}
-
-private:
-	void draw_body() {
-		std::for_each(_body_parts.begin(), _body_parts.end(),
-			      [this](const std::pair<unsigned short, unsigned short>& part) {
-				      mvprintw(part.second, part.first, _body_fill);
-			      }
-		);
-	}
-
-	void move_body() {
-		coordinates last;
-		if (_will_be_grown) {
-			last = _body_parts.back();
-		}
-		for (auto it = _body_parts.rbegin(), end = _body_parts.rend() - 1; it != end; ++it) {
-			*it = *(it + 1);
-		}
-		if (_will_be_grown) {
-			_body_parts.emplace_back(last);
-			_will_be_grown = false;
-		}
-		switch (_direction) {
-			case Up:
-				_body_parts[0].second--;
-				break;
-			case Right:
-				_body_parts[0].first++;
-				break;
-			case Down:
-				_body_parts[0].second++;
-				break;
-			case Left:
-				_body_parts[0].first--;
-				break;
-			default:
-				break;
-		}
-	}
-
-	bool _will_be_grown{false};
-	std::vector<coordinates> _body_parts;
-	const char * _body_fill{"@"};
-	Direction _direction;
-};
-
-/*
- * 		Screen
- */
-class Screen {
-public:
-	Screen(unsigned short & width, unsigned short & height) :
-		_width{width}, _height{height} {}
-
-	virtual ~Screen() = default;
-
-	virtual void render() noexcept = 0;
-	virtual void input_handler(int, AppStatus&) noexcept = 0;
-
-protected:
-	unsigned short get_width() const noexcept {
-		return _width;
-	}
-
-	unsigned short get_height() const noexcept {
-		return _height;
-	}
-
-	void clear_once() noexcept {
-		if (!_was_cleaned) {
-			clear();
-			_was_cleaned = true;
-		}
-	}
-
-	void on_leave() noexcept {
-		_was_cleaned = false;
-	}
-
-	void print_on_center(std::string_view msg) const noexcept {
-		mvprintw(_height / 2, (_width / 2) - (msg.size() / 2), msg.data());
-	}
-
-private:
-	unsigned short & _width;
-	unsigned short & _height;
-	bool _was_cleaned{false};
-};
-
-/*
- * 		Game
- */
-class Game : public Screen {
-public:
-	Game(unsigned short &width, unsigned short &height) : Screen(width, height) {
-		_coords_generator = new RandomCoordinatesGenerator(width, height);
-		_snake = new Snake{10, 10, Right};
-
-		generate_food();
-	}
-
-	~Game() override {
-		delete _snake;
-		delete _coords_generator;
-	}
-
-	void render() noexcept override {
-		clear_once();
-		switch (_game_status) {
-			case RUN:
-			{
-				auto now = std::chrono::system_clock::now();
-				if ( std::chrono::duration_cast<std::chrono::milliseconds>(now - _previous_render).count() > _speed ) {
-					_previous_render = now;
-
-					_snake->render();
-
-					draw_food_trace();
-					draw_score();
-					draw_food();
-
-					if (check_food()) {
-						_score++;
-						_speed -= (_speed > 20) ? 5 : 0;
-						_snake->grow_up();
-						generate_food();
-					}
-
-					if (check_collision() || _snake->check_self_abuse()) {
-						_game_status = GAME_OVER;
-					}
-				}
-				break;
-			}
-			case PAUSE:
-				print_on_center("game paused, press p to unpause");
-				break;
-			case GAME_OVER:
-				print_on_center("GAME OVER. Press r to restart or q to quit in menu");
-				break;
-			default:
-				break;
-		}
-	}
-
-	void input_handler(int input, AppStatus& status) noexcept override {
-		switch (input) {
-			case KEY_UP:
-				if (_snake->getDirection() != Down)
-					_snake->setDirection(Up);
-				break;
-			case KEY_RIGHT:
-				if (_snake->getDirection() != Left)
-					_snake->setDirection(Right);
-				break;
-			case KEY_DOWN:
-				if (_snake->getDirection() != Up)
-					_snake->setDirection(Down);
-				break;
-			case KEY_LEFT:
-				if (_snake->getDirection() != Right)
-					_snake->setDirection(Left);
-				break;
-			case 'q':
-				on_leave();
-				status = MENU;
-				break;
-			case 'p':
-				_game_status = (_game_status == PAUSE) ? RUN : PAUSE;
-				break;
-			case 'r':
-				restart();
-				_game_status = PAUSE;
-			default:
-				break;
-		}
-	}
-
-private:
-	bool check_collision() {
-		auto [pos_x, pos_y] = _snake->getHead();
-		return !(pos_x > 0 && pos_y > 0 && pos_x < get_width() && pos_y < get_height());
-	}
-
-	void generate_food() {
-		_food =  _coords_generator->get();
-		while (_snake->is_part_of_body(_food)) {
-			_food = _coords_generator->get();
-		}
-	}
-
-	void draw_food() {
-		mvprintw(_food.second, _food.first, "$");
-	}
-
-	bool check_food() {
-		return _food == _snake->getHead();
-	}
-
-	void draw_score() {
-		mvprintw(1, get_width() / 2, "score %d", _score);
-	}
-
-	void draw_food_trace() {
-		mvprintw(1, 2, "x: %d", _food.first);
-		mvprintw(2, 2, "y: %d", _food.second);
-	}
-
-	void restart() noexcept {
-		_snake->reset();
-	}
-
-	unsigned short _speed{150};
-	unsigned short _score{0};
-	std::chrono::system_clock::time_point _previous_render;
-	coordinates _food;
-	RandomCoordinatesGenerator* _coords_generator;
-	Snake* _snake;
-	GameStatus _game_status{RUN};
-};
-
-/*	
- * 		MENU
- */
-class Menu : public Screen {
-public:
-	Menu(unsigned short &width, unsigned short &height) : Screen(width, height) {}
-
-	void render() noexcept override {
-		clear_once();
-		for (int i = 0; i < _menu_options.size(); ++i) {
-			if (i == _current_option) {
-				attron(COLOR_PAIR(1));
-				mvprintw(get_height() / 2 + i, get_width() / 2, _menu_options[i].c_str());
-				attroff(COLOR_PAIR(1));
-			} else {
-				mvprintw(get_height() / 2 + i, get_width() / 2, _menu_options[i].c_str());
-			}
-		}
-	}
-
-	void input_handler(int input, AppStatus& status) noexcept override {
-		switch (input) {
-			case KEY_UP:
-				if (_current_option != 0) {
-					_current_option--;
-				} else {
-					_current_option = _menu_options.size() - 1;
-				}
-				break;
-			case KEY_DOWN:
-				if (_current_option != _menu_options.size() - 1) {
-					_current_option++;
-				} else {
-					_current_option = 0;
-				}
-				break;
-			case '\n':
-				on_leave();
-				status = static_cast<AppStatus>(_current_option + 1);
-			default:
-				break;
-		}
-	}
-
-private:
-	std::array<std::string, 3> _menu_options{ {"Start", "Info", "Exit"} };
-	unsigned short _current_option{0};
-};
-
-/*
- * 		Info
- */
-class Info : public Screen {
-public:
-	Info(unsigned short &width, unsigned short &height) : Screen(width, height) {}
-
-	void render() noexcept override {
-		clear_once();
-		print_on_center("print q to back in menu");
-	}
-
-	void input_handler(int input, AppStatus& status) noexcept override {
-		switch (input) {
-			case 'q':
-				on_leave();
-				status = MENU;
-				break;
-			default:
-				break;
-		}
-	}
+#include <string>
 
-};
+#include "types.h"
+#include "tick_timer.h"
+#include "frame_pacer.h"
+#include "trace.h"
+#include "ncurses_renderer.h"
+#include "game.h"
+#include "menu.h"
+#include "info.h"
+#include "arena.h"
 
 class SnakeGame {
 public:
-	SnakeGame() {
+	// Rewinding reaches back rewind_seconds at the fastest tick rate: turbo, or 50 ticks/s at top speed
+	SnakeGame(unsigned int turbo_rate, unsigned int rewind_seconds, const char* checkpoint_path,
+		  const char* leaderboard_path) :
+		_rewind(static_cast<size_t>(rewind_seconds) * std::max(turbo_rate, 50u))
+	{
 		// Init screen
 		initscr();
 		// Get current size of terminal window
 		getmaxyx(stdscr, _height, _width);
 
-		_menu = new Menu(_width, _height);
-		_info = new Info(_width, _height);
-		_game = new Game(_width, _height);
+		_menu = new Menu(_width, _height, _renderer);
+		_info = new Info(_width, _height, _renderer);
+		_game = new Game(_width, _height, _renderer);
+		_game->attach_timer(_tick_timer);
+		_game->attach_pacer(_frame_pacer);
+		_game->set_turbo(turbo_rate);
+		_game->attach_rewind(_rewind);
+		// A game left running by a crashed or disconnected SnakeGame picks up where it was, paused
+		if (checkpoint_path && _checkpoint.open(checkpoint_path, _width, _height)) {
+			if (_game->resume(_checkpoint)) {
+				_status = GAME;
+			}
+			_game->attach_checkpoint(_checkpoint);
+		}
+		if (leaderboard_path && _leaderboard.open(leaderboard_path)) {
+			_game->attach_leaderboard(_leaderboard);
+			_info->attach_leaderboard(_leaderboard);
+		}
+		_arena = new Arena(_width, _height, _renderer);
 	}
 
 	~SnakeGame() {
+		delete _arena;
 		delete _game;
 		delete _info;
 		delete _menu;
@@ -449,13 +78,27 @@ private:
 		// Make available colors
 		start_color();
 		// Init own color scheme
+		use_default_colors();
 		init_pair(1, COLOR_CYAN, COLOR_BLUE);
+		init_pair(HEAD_COLOR_PAIR, COLOR_YELLOW, -1);
+		init_pair(BODY_COLOR_PAIR, COLOR_GREEN, -1);
+		init_pair(FOOD_COLOR_PAIR, COLOR_RED, -1);
 	}
 
 	void render() {
 		while (_status != EXIT) {
-			box(stdscr, 0, 0);
-			refresh();
+			// Arena boards have their own windows and borders
+			if (_status != ARENA) {
+				_renderer.draw_border();
+				auto started = FramePacer::clock::now();
+				{
+					TraceSpan span("refresh");
+					_renderer.present();
+				}
+				auto presented = FramePacer::clock::now();
+				_frame_pacer.on_present(presented, presented - started);
+				_renderer.set_incremental(_frame_pacer.incremental());
+			}
 			if ( (_input = getch()) == ERR ) {
 				switch (_status) {
 					case MENU:
@@ -464,12 +107,18 @@ private:
 					case INFO:
 						_info->render();
 						break;
+					case ARENA:
+						_arena->render();
+						break;
 					case GAME:
 						_game->render();
+						wait_for_tick();
+						break;
 					default:
 						break;
 				}
 			} else {
+				TraceSpan span("input");
 				switch (_status) {
 					case MENU:
 						_menu->input_handler(_input, _status);
@@ -480,6 +129,9 @@ private:
 					case GAME:
 						_game->input_handler(_input, _status);
 						break;
+					case ARENA:
+						_arena->input_handler(_input, _status);
+						break;
 					default:
 						break;
 				}
@@ -488,18 +140,62 @@ private:
 		endwin();
 	}
 
+	NcursesRenderer _renderer;
+	// Sleep until a key is pressed or the next game tick is due
+	void wait_for_tick() {
+		pollfd fds[2] = { {STDIN_FILENO, POLLIN, 0}, {_tick_timer.fd(), POLLIN, 0} };
+		poll(fds, 2, 50);
+	}
+
+	TickTimer _tick_timer;
+	FramePacer _frame_pacer{STDOUT_FILENO};
+	RewindBuffer _rewind;
+	Checkpoint _checkpoint;
+	Leaderboard _leaderboard;
 	Menu* _menu;
 	Info* _info;
 	Game* _game;
+	Arena* _arena;
 
 	AppStatus _status{MENU};
 	unsigned short _height{}, _width{};
 	int _input{};
 };
 
-int main() {
-	auto game = std::make_unique<SnakeGame>();
+int main(int argc, char** argv) {
+	unsigned int turbo_rate = 0;
+	unsigned int rewind_seconds = 30;
+	const char* trace_path = nullptr;
+	std::string checkpoint_path = std::getenv("HOME") ? std::string(std::getenv("HOME")) + "/.snake_checkpoint" : "";
+	std::string leaderboard_path = "/tmp/snake_leaderboard";
+	for (int i = 1; i < argc; ++i) {
+		if (i + 1 < argc && !std::strcmp(argv[i], "--turbo")) {
+			turbo_rate = std::strtoul(argv[++i], nullptr, 10);
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--rewind")) {
+			rewind_seconds = std::strtoul(argv[++i], nullptr, 10);
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--checkpoint")) {
+			checkpoint_path = argv[++i];
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--leaderboard")) {
+			leaderboard_path = argv[++i];
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--trace")) {
+			trace_path = argv[++i];
+			Trace::enable();
+		} else {
+			std::cerr << "usage: " << argv[0] << " [--turbo TICKS_PER_SECOND] [--rewind SECONDS] [--checkpoint FILE]\n\t[--leaderboard FILE] [--trace FILE]" << std::endl;
+			return 1;
+		}
+	}
+
+	// UTF-8 glyphs need the user's locale before ncurses starts
+	setlocale(LC_ALL, "");
+	auto game = std::make_unique<SnakeGame>(turbo_rate, rewind_seconds,
+						checkpoint_path.empty() ? nullptr : checkpoint_path.c_str(),
+						leaderboard_path.empty() ? nullptr : leaderboard_path.c_str());
 	game->start();
+	if (trace_path && !Trace::write(trace_path)) {
+		std::cerr << "cannot write trace to " << trace_path << std::endl;
+		return 1;
+	}
 	return 0;
 }
 
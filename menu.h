@@ -0,0 +1,56 @@
+#pragma once
+
+#include <ncurses.h>
+#include <array>
+#include <string>
+
+#include "screen.h"
+
+/*	
+ * 		MENU
+ */
+class Menu : public Screen {
+public:
+	Menu(unsigned short &width, unsigned short &height, Renderer &renderer) : Screen(width, height, renderer) {}
+
+	void render() noexcept override {
+		clear_once();
+		for (int i = 0; i < _menu_options.size(); ++i) {
+			if (i == _current_option) {
+				renderer().highlight(true);
+				renderer().put(get_height() / 2 + i, get_width() / 2, _menu_options[i]);
+				renderer().highlight(false);
+			} else {
+				renderer().put(get_height() / 2 + i, get_width() / 2, _menu_options[i]);
+			}
+		}
+	}
+
+	void input_handler(int input, AppStatus& status) noexcept override {
+		switch (input) {
+			case KEY_UP:
+				if (_current_option != 0) {
+					_current_option--;
+				} else {
+					_current_option = _menu_options.size() - 1;
+				}
+				break;
+			case KEY_DOWN:
+				if (_current_option != _menu_options.size() - 1) {
+					_current_option++;
+				} else {
+					_current_option = 0;
+				}
+				break;
+			case '\n':
+				on_leave();
+				status = static_cast<AppStatus>(_current_option + 1);
+			default:
+				break;
+		}
+	}
+
+private:
+	std::array<std::string, 4> _menu_options{ {"Start", "Info", "Bots", "Exit"} };
+	unsigned short _current_option{0};
+};
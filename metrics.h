@@ -0,0 +1,157 @@
+#pragma once
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+#include "stats.h"
+
+/*
+ * 		PrometheusText
+ *
+ * Builder for the Prometheus text exposition format.
+ */
+class PrometheusText {
+public:
+	void header(const char* name, const char* type, const char* help) {
+		_text += "# HELP ";
+		_text += name;
+		_text += ' ';
+		_text += help;
+		_text += "\n# TYPE ";
+		_text += name;
+		_text += ' ';
+		_text += type;
+		_text += '\n';
+	}
+
+	void sample(const char* name, double value, const std::string& labels = {}) {
+		_text += name;
+		if (!labels.empty()) {
+			_text += '{';
+			_text += labels;
+			_text += '}';
+		}
+		_text += ' ';
+		_text += format(value);
+		_text += '\n';
+	}
+
+	void histogram(const char* name, const LatencyHistogram::Snapshot& snapshot) {
+		std::uint64_t cumulative = 0;
+		std::string bucket = std::string(name) + "_bucket";
+		for (size_t i = 0; i < LatencyHistogram::buckets_count; ++i) {
+			cumulative += snapshot.buckets[i];
+			std::string le = i < LatencyHistogram::bounds_us.size()
+					 ? format(LatencyHistogram::bounds_us[i] / 1e6) : "+Inf";
+			sample(bucket.c_str(), cumulative, "le=\"" + le + "\"");
+		}
+		sample((std::string(name) + "_sum").c_str(), snapshot.sum_us / 1e6);
+		sample((std::string(name) + "_count").c_str(), snapshot.count);
+	}
+
+	void summary(const char* name, const LatencyHistogram::Snapshot& snapshot) {
+		for (double q : {0.5, 0.9, 0.99}) {
+			sample(name, snapshot.quantile(q), "quantile=\"" + format(q) + "\"");
+		}
+		sample((std::string(name) + "_sum").c_str(), snapshot.sum_us / 1e6);
+		sample((std::string(name) + "_count").c_str(), snapshot.count);
+	}
+
+	const std::string& str() const noexcept {
+		return _text;
+	}
+
+private:
+	static std::string format(double value) {
+		char buffer[32];
+		int size = std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+		return std::string(buffer, size);
+	}
+
+	std::string _text;
+};
+
+/*
+ * 		MetricsEndpoint
+ *
+ * Minimal HTTP server on a loopback port answering every request with the
+ * current metrics; runs on its own thread so scrapes never touch reactors.
+ */
+class MetricsEndpoint {
+public:
+	MetricsEndpoint(unsigned short port, std::function<std::string()> render) :
+		_render{std::move(render)}
+	{
+		_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		int reuse = 1;
+		setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+		sockaddr_in address{};
+		address.sin_family = AF_INET;
+		address.sin_port = htons(port);
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		if (bind(_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(_fd, 16) != 0) {
+			close(_fd);
+			_fd = -1;
+			return;
+		}
+		_thread = std::thread([this] { serve(); });
+	}
+
+	~MetricsEndpoint() {
+		if (_fd >= 0) {
+			shutdown(_fd, SHUT_RDWR);
+			close(_fd);
+		}
+		if (_thread.joinable()) {
+			_thread.join();
+		}
+	}
+
+	bool listening() const noexcept {
+		return _fd >= 0;
+	}
+
+private:
+	void serve() {
+		while (true) {
+			int client = accept4(_fd, nullptr, nullptr, SOCK_CLOEXEC);
+			if (client < 0) {
+				if (errno == EINTR || errno == ECONNABORTED) {
+					continue;
+				}
+				return;
+			}
+			// The request itself does not matter, every path returns the metrics
+			char request[1024];
+			if (read(client, request, sizeof(request)) > 0) {
+				std::string body = _render();
+				std::string response = "HTTP/1.0 200 OK\r\n"
+						       "Content-Type: text/plain; version=0.0.4\r\n"
+						       "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+				for (size_t written = 0; written < response.size(); ) {
+					ssize_t result = write(client, response.data() + written, response.size() - written);
+					if (result <= 0) {
+						break;
+					}
+					written += result;
+				}
+			}
+			close(client);
+		}
+	}
+
+	int _fd{-1};
+	std::function<std::string()> _render;
+	std::thread _thread;
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <ncurses.h>
+
+#include "renderer.h"
+
+/*
+ * 		NcursesRenderer
+ */
+class NcursesRenderer : public Renderer {
+public:
+	explicit NcursesRenderer(const GlyphCache& glyphs = GlyphCache::for_locale()) noexcept : _glyphs{glyphs} {}
+
+	// clear() repaints the whole terminal on the next refresh, erase() lets ncurses send only the changes
+	void set_incremental(bool incremental) noexcept {
+		_incremental = incremental;
+	}
+
+	void clear_screen() noexcept override {
+		if (_incremental) {
+			erase();
+		} else {
+			clear();
+		}
+	}
+
+	void put(unsigned short y, unsigned short x, std::string_view text) noexcept override {
+		mvaddnstr(y, x, text.data(), text.size());
+	}
+
+	void put_glyph(unsigned short y, unsigned short x, Glyph glyph) noexcept override {
+		const GlyphCache::Encoded& encoded = _glyphs[glyph];
+		attron(COLOR_PAIR(encoded.color_pair));
+		mvaddnstr(y, x, encoded.text().data(), encoded.text().size());
+		attroff(COLOR_PAIR(encoded.color_pair));
+	}
+
+	void highlight(bool on) noexcept override {
+		if (on) {
+			attron(COLOR_PAIR(1));
+		} else {
+			attroff(COLOR_PAIR(1));
+		}
+	}
+
+	void draw_border() noexcept override {
+		box(stdscr, 0, 0);
+	}
+
+	void present() noexcept override {
+		refresh();
+	}
+
+private:
+	const GlyphCache& _glyphs;
+	bool _incremental{false};
+};
+
+/*
+ * 		NcursesWindowRenderer
+ *
+ * Draws into its own window. Clearing erases instead of forcing a full
+ * repaint and present() only stages the window, so several windows can be
+ * flushed together by one doupdate() and ncurses sends just what changed.
+ */
+class NcursesWindowRenderer : public Renderer {
+public:
+	explicit NcursesWindowRenderer(WINDOW* window, const GlyphCache& glyphs = GlyphCache::for_locale()) noexcept :
+		_window{window}, _glyphs{glyphs} {}
+
+	void clear_screen() noexcept override {
+		werase(_window);
+	}
+
+	void put(unsigned short y, unsigned short x, std::string_view text) noexcept override {
+		mvwaddnstr(_window, y, x, text.data(), text.size());
+	}
+
+	void put_glyph(unsigned short y, unsigned short x, Glyph glyph) noexcept override {
+		const GlyphCache::Encoded& encoded = _glyphs[glyph];
+		wattron(_window, COLOR_PAIR(encoded.color_pair));
+		mvwaddnstr(_window, y, x, encoded.text().data(), encoded.text().size());
+		wattroff(_window, COLOR_PAIR(encoded.color_pair));
+	}
+
+	void highlight(bool on) noexcept override {
+		if (on) {
+			wattron(_window, COLOR_PAIR(1));
+		} else {
+			wattroff(_window, COLOR_PAIR(1));
+		}
+	}
+
+	void draw_border() noexcept override {
+		box(_window, 0, 0);
+	}
+
+	void present() noexcept override {
+		wnoutrefresh(_window);
+	}
+
+private:
+	WINDOW* _window;
+	const GlyphCache& _glyphs;
+};
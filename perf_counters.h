@@ -0,0 +1,107 @@
+#pragma once
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+/*
+ * 		PerfCounters
+ *
+ * Hardware counters of the calling thread via perf_event_open, read as one
+ * group so all values cover exactly the same interval. Where the kernel or
+ * the container refuses access (perf_event_paranoid, no PMU in a VM)
+ * available() is false and readings are zero.
+ */
+class PerfCounters {
+public:
+	enum Counter {
+		CYCLES,
+		INSTRUCTIONS,
+		CACHE_MISSES,
+		BRANCH_MISSES,
+		COUNTERS_COUNT
+	};
+
+	struct Reading {
+		std::array<std::uint64_t, COUNTERS_COUNT> values{};
+
+		std::uint64_t operator[](Counter counter) const noexcept {
+			return values[counter];
+		}
+	};
+
+	PerfCounters() noexcept {
+		const std::uint64_t configs[COUNTERS_COUNT] = {
+			PERF_COUNT_HW_CPU_CYCLES,
+			PERF_COUNT_HW_INSTRUCTIONS,
+			PERF_COUNT_HW_CACHE_MISSES,
+			PERF_COUNT_HW_BRANCH_MISSES
+		};
+		for (int counter = 0; counter < COUNTERS_COUNT; ++counter) {
+			perf_event_attr attr;
+			std::memset(&attr, 0, sizeof(attr));
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.size = sizeof(attr);
+			attr.config = configs[counter];
+			attr.disabled = counter == 0;	// the leader starts and stops the whole group
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			attr.read_format = PERF_FORMAT_GROUP;
+			_fds[counter] = syscall(SYS_perf_event_open, &attr, 0, -1, counter == 0 ? -1 : _fds[0], 0);
+			if (_fds[counter] < 0) {
+				close_all();
+				return;
+			}
+		}
+	}
+
+	~PerfCounters() {
+		close_all();
+	}
+
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+
+	bool available() const noexcept {
+		return _fds[0] >= 0;
+	}
+
+	void start() noexcept {
+		if (available()) {
+			ioctl(_fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+			ioctl(_fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+		}
+	}
+
+	Reading stop() noexcept {
+		Reading reading;
+		if (!available()) {
+			return reading;
+		}
+		ioctl(_fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+		// PERF_FORMAT_GROUP layout: number of events, then one value per event
+		std::uint64_t buffer[1 + COUNTERS_COUNT] = {};
+		if (read(_fds[0], buffer, sizeof(buffer)) == sizeof(buffer)) {
+			for (int counter = 0; counter < COUNTERS_COUNT; ++counter) {
+				reading.values[counter] = buffer[1 + counter];
+			}
+		}
+		return reading;
+	}
+
+private:
+	void close_all() noexcept {
+		for (int& fd : _fds) {
+			if (fd >= 0) {
+				close(fd);
+			}
+			fd = -1;
+		}
+	}
+
+	std::array<int, COUNTERS_COUNT> _fds{ {-1, -1, -1, -1} };
+};
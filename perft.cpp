@@ -0,0 +1,233 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "framebuffer_renderer.h"
+#include "game.h"
+#include "bot.h"
+#include "thread_pool.h"
+
+namespace {
+
+struct PerftOptions {
+	unsigned short width{80};
+	unsigned short height{24};
+	unsigned int depth{10};
+	unsigned int seed{42};
+	unsigned int threads{std::thread::hardware_concurrency()};
+};
+
+PerftOptions parse_options(int argc, char** argv) {
+	PerftOptions options;
+	for (int i = 1; i < argc; ++i) {
+		if (i + 1 < argc && !std::strcmp(argv[i], "--depth")) {
+			options.depth = std::max(1, std::atoi(argv[++i]));
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--seed")) {
+			options.seed = std::strtoul(argv[++i], nullptr, 10);
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--threads")) {
+			options.threads = std::max(1, std::atoi(argv[++i]));
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--board")) {
+			unsigned int width = 0, height = 0;
+			if (std::sscanf(argv[++i], "%ux%u", &width, &height) != 2 || width < 12 || height < 12) {
+				std::fprintf(stderr, "board must be WIDTHxHEIGHT, at least 12x12\n");
+				std::exit(1);
+			}
+			options.width = width;
+			options.height = height;
+		} else {
+			std::fprintf(stderr, "usage: %s [--depth N] [--board WxH] [--seed S] [--threads N]\n", argv[0]);
+			std::exit(1);
+		}
+	}
+	return options;
+}
+
+/*
+ * 		PerftCounts
+ *
+ * Outcomes per ply: positions still running, games that ended, and food
+ * eaten on that tick. The checksum folds every position left at the last
+ * ply in an order-independent way, so any change in the engine's rules
+ * shows up even when the counts happen to match.
+ */
+struct PerftCounts {
+	explicit PerftCounts(unsigned int depth) : alive(depth + 1), game_over(depth + 1), food(depth + 1) {}
+
+	void merge(const PerftCounts& other) noexcept {
+		for (size_t ply = 0; ply < alive.size(); ++ply) {
+			alive[ply] += other.alive[ply];
+			game_over[ply] += other.game_over[ply];
+			food[ply] += other.food[ply];
+		}
+		checksum += other.checksum;
+	}
+
+	std::uint64_t nodes() const noexcept {
+		std::uint64_t total = 0;
+		for (size_t ply = 1; ply < alive.size(); ++ply) {
+			total += alive[ply] + game_over[ply];
+		}
+		return total;
+	}
+
+	std::vector<std::uint64_t> alive;
+	std::vector<std::uint64_t> game_over;
+	std::vector<std::uint64_t> food;
+	std::uint64_t checksum{0};
+};
+
+std::uint64_t mix(std::uint64_t value) noexcept {
+	value ^= value >> 33;
+	value *= 0xff51afd7ed558ccdULL;
+	value ^= value >> 33;
+	value *= 0xc4ceb9fe1a85ec53ULL;
+	return value ^ (value >> 33);
+}
+
+std::uint64_t fingerprint(const Game& game) noexcept {
+	std::uint64_t hash = mix(static_cast<std::uint64_t>(game.food().first) << 48 |
+				 static_cast<std::uint64_t>(game.food().second) << 32 |
+				 static_cast<std::uint64_t>(game.snake().getDirection()) << 16 | game.score());
+	for (const coordinates& part : game.snake().body()) {
+		hash = mix(hash ^ (static_cast<std::uint64_t>(part.first) << 16 | part.second));
+	}
+	return hash;
+}
+
+/*
+ * 		Perft
+ *
+ * Depth-first walk over every sequence of the three moves the reverse rule
+ * allows. Each ply steps a copy of its parent kept in a per-ply stack of
+ * games, so the walk reuses their buffers instead of allocating per node.
+ */
+class Perft {
+public:
+	Perft(const Game& root, unsigned int depth) : _counts(depth) {
+		_stack.reserve(depth + 1);
+		for (unsigned int ply = 0; ply <= depth; ++ply) {
+			_stack.push_back(root);
+		}
+	}
+
+	// Walks the subtree below `root`, which sits at ply `from`
+	void run(const Game& root, unsigned int from) noexcept {
+		_stack[from].load_state(root);
+		walk(from);
+	}
+
+	const PerftCounts& counts() const noexcept {
+		return _counts;
+	}
+
+private:
+	void walk(unsigned int ply) noexcept {
+		const Game& parent = _stack[ply];
+		Game& child = _stack[ply + 1];
+		bool last = ply + 2 == _stack.size();
+		for (Direction direction : all_directions) {
+			if (direction == opposite(parent.snake().getDirection())) {
+				continue;
+			}
+			child.load_state(parent);
+			child.turn(direction);
+			child.tick();
+			if (child.score() != parent.score()) {
+				_counts.food[ply + 1]++;
+			}
+			if (child.status() == GAME_OVER) {
+				_counts.game_over[ply + 1]++;
+				continue;
+			}
+			_counts.alive[ply + 1]++;
+			if (last) {
+				_counts.checksum += fingerprint(child);
+			} else {
+				walk(ply + 1);
+			}
+		}
+	}
+
+	std::vector<Game> _stack;
+	PerftCounts _counts;
+};
+
+// Positions at `ply`, expanded breadth-first; the counts up to it go into `counts`
+std::vector<Game> frontier(const Game& root, unsigned int ply, PerftCounts& counts) {
+	std::vector<Game> level{root};
+	for (unsigned int depth = 1; depth <= ply; ++depth) {
+		std::vector<Game> next;
+		for (const Game& parent : level) {
+			for (Direction direction : all_directions) {
+				if (direction == opposite(parent.snake().getDirection())) {
+					continue;
+				}
+				next.push_back(parent);
+				Game& child = next.back();
+				child.turn(direction);
+				child.tick();
+				if (child.score() != parent.score()) {
+					counts.food[depth]++;
+				}
+				if (child.status() == GAME_OVER) {
+					counts.game_over[depth]++;
+					next.pop_back();
+				} else {
+					counts.alive[depth]++;
+				}
+			}
+		}
+		level.swap(next);
+	}
+	return level;
+}
+
+} // local namespace
+
+int main(int argc, char** argv) {
+	PerftOptions options = parse_options(argc, argv);
+	unsigned short width = options.width;
+	unsigned short height = options.height;
+	// Games need a renderer, but perft only ticks and never draws
+	FramebufferRenderer unused(width, height);
+	Game root(width, height, unused, options.seed);
+	ThreadPool pool(options.threads);
+
+	// Split near the root until there is enough work to balance across threads
+	unsigned int split = 0;
+	for (std::uint64_t subtrees = 1; split + 1 < options.depth && subtrees < pool.size() * 16ull; subtrees *= 3) {
+		split++;
+	}
+
+	auto started = std::chrono::steady_clock::now();
+	PerftCounts counts(options.depth);
+	std::vector<Game> subtrees = frontier(root, split, counts);
+	std::vector<PerftCounts> results(subtrees.size(), PerftCounts(options.depth));
+	pool.run(subtrees.size(), [&](size_t i) {
+		Perft perft(root, options.depth);
+		perft.run(subtrees[i], split);
+		results[i] = perft.counts();
+	});
+	for (const PerftCounts& result : results) {
+		counts.merge(result);
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+
+	std::printf("board %ux%u, seed %u, depth %u, %u thread(s), split at ply %u into %zu subtrees\n",
+		    width, height, options.seed, options.depth, pool.size(), split, subtrees.size());
+	std::printf("%5s %14s %14s %14s\n", "ply", "running", "game over", "food eaten");
+	for (unsigned int ply = 1; ply <= options.depth; ++ply) {
+		std::printf("%5u %14llu %14llu %14llu\n", ply, static_cast<unsigned long long>(counts.alive[ply]),
+			    static_cast<unsigned long long>(counts.game_over[ply]),
+			    static_cast<unsigned long long>(counts.food[ply]));
+	}
+	std::printf("checksum %016llx\n", static_cast<unsigned long long>(counts.checksum));
+	std::printf("%llu nodes in %.3f s, %.0f nodes/s\n", static_cast<unsigned long long>(counts.nodes()),
+		    elapsed.count(), counts.nodes() / elapsed.count());
+	return 0;
+}
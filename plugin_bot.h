@@ -0,0 +1,209 @@
+#pragma once
+
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "types.h"
+#include "game.h"
+#include "bot.h"
+#include "external_bot.h"
+#include "snake_bot_api.h"
+
+static_assert(sizeof(coordinates) == sizeof(snake_cell) && std::is_standard_layout_v<coordinates>,
+	      "the plugin view hands out the snake body in place");
+
+/*
+ * 		PluginBot
+ *
+ * A bot living in a shared object (see snake_bot_api.h), called directly
+ * through its function pointers: a move costs an indirect call, the same as
+ * a built-in bot. The board view points into the game's own body.
+ *
+ * Between games the file's modification time is checked and a rebuilt
+ * plugin is loaded in place of the old one. The engine dlopens a private
+ * copy of the file, so a compiler overwriting it in place cannot pull the
+ * code from under a running bot and dlopen never hands back the cached old
+ * image. A rebuild that fails to load leaves the old plugin playing.
+ */
+class PluginBot : public Bot {
+public:
+	PluginBot(std::string path, unsigned int seed) : _path(std::move(path)), _seed(seed) {
+		reload();
+	}
+
+	~PluginBot() override {
+		unload();
+	}
+
+	PluginBot(const PluginBot&) = delete;
+	PluginBot& operator=(const PluginBot&) = delete;
+
+	bool loaded() const noexcept {
+		return _plugin != nullptr;
+	}
+
+	// Why the latest load failed; empty when it worked
+	const std::string& error() const noexcept {
+		return _error;
+	}
+
+	// Times the plugin was (re)loaded
+	unsigned int loads() const noexcept {
+		return _loads;
+	}
+
+	const char * name() const noexcept override {
+		return _plugin ? _plugin->name : "plugin";
+	}
+
+	void on_game_start() noexcept override {
+		struct stat status{};
+		if (stat(_path.c_str(), &status) == 0 && status.st_mtim.tv_sec != 0 &&
+		    (status.st_mtim.tv_sec != _modified.tv_sec || status.st_mtim.tv_nsec != _modified.tv_nsec)) {
+			reload();
+		}
+		if (_plugin && _plugin->game_start) {
+			_plugin->game_start(_bot);
+		}
+	}
+
+	Direction next_move(const Game& game) noexcept override {
+		const Snake& snake = game.snake();
+		if (!_plugin) {
+			return snake.getDirection();
+		}
+		snake_board_view view{
+			game.get_width(), game.get_height(), game.score(),
+			static_cast<unsigned char>(snake.getDirection()), snake.growing(),
+			{game.food().first, game.food().second},
+			static_cast<unsigned int>(snake.body().size()),
+			reinterpret_cast<const snake_cell*>(snake.body().data())
+		};
+		int move = _plugin->next_move(_bot, &view);
+		return move >= Up && move <= Left ? static_cast<Direction>(move) : snake.getDirection();
+	}
+
+private:
+	// Load the current file; keeps the running plugin if that fails
+	void reload() {
+		struct stat status{};
+		if (stat(_path.c_str(), &status) != 0) {
+			_error = _path + ": " + std::strerror(errno);
+			return;
+		}
+		_modified = status.st_mtim;
+
+		std::string copy;
+		if (!private_copy(copy)) {
+			return;
+		}
+		void* handle = dlopen(copy.c_str(), RTLD_NOW | RTLD_LOCAL);
+		unlink(copy.c_str());
+		if (!handle) {
+			_error = _path + ": " + dlerror();
+			return;
+		}
+		auto entry = reinterpret_cast<snake_bot_plugin_entry>(dlsym(handle, "snake_bot_plugin"));
+		const struct snake_bot_plugin* plugin = entry ? entry() : nullptr;
+		if (!plugin || plugin->api_version != SNAKE_BOT_API_VERSION || !plugin->next_move) {
+			_error = _path + ": no snake_bot_plugin() for API version " + std::to_string(SNAKE_BOT_API_VERSION);
+			dlclose(handle);
+			return;
+		}
+		unload();
+		_handle = handle;
+		_plugin = plugin;
+		_bot = plugin->create ? plugin->create(_seed) : nullptr;
+		_error.clear();
+		_loads++;
+	}
+
+	void unload() noexcept {
+		if (_plugin && _plugin->destroy) {
+			_plugin->destroy(_bot);
+		}
+		if (_handle) {
+			dlclose(_handle);
+		}
+		_handle = nullptr;
+		_plugin = nullptr;
+		_bot = nullptr;
+	}
+
+	// Snapshot the plugin into a temporary file of its own
+	bool private_copy(std::string& copy) {
+		char name[] = "/tmp/snake-plugin-XXXXXX";
+		int to = mkstemp(name);
+		int from = ::open(_path.c_str(), O_RDONLY | O_CLOEXEC);
+		struct stat status{};
+		bool copied = to >= 0 && from >= 0 && fstat(from, &status) == 0;
+		for (off_t offset = 0; copied && offset < status.st_size;) {
+			copied = sendfile(to, from, &offset, status.st_size - offset) > 0;
+		}
+		if (from >= 0) {
+			close(from);
+		}
+		if (to >= 0) {
+			close(to);
+		}
+		if (!copied) {
+			_error = _path + ": cannot copy: " + std::strerror(errno);
+			if (to >= 0) {
+				unlink(name);
+			}
+			return false;
+		}
+		copy = name;
+		return true;
+	}
+
+	std::string _path;
+	unsigned int _seed;
+	timespec _modified{};
+	void* _handle{nullptr};
+	const struct snake_bot_plugin* _plugin{nullptr};
+	void* _bot{nullptr};
+	std::string _error;
+	unsigned int _loads{0};
+};
+
+// A bot by name: a built-in one (see make_builtin_bot for `search_nodes`),
+// "exec:COMMAND" for an external process answering within `deadline`, or a
+// plugin when the name is a path to a shared object. nullptr when it cannot
+// be made; `error` then says why.
+inline std::unique_ptr<Bot> make_bot(std::string_view name, unsigned int seed, std::string* error = nullptr,
+				     std::chrono::microseconds deadline = ExternalBotProcess::default_deadline,
+				     unsigned int search_nodes = 0) {
+	if (name.substr(0, 5) == "exec:") {
+		auto bot = std::make_unique<ExternalBot>(std::string(name.substr(5)), deadline);
+		if (!bot->process().running() && error) {
+			*error = "cannot start " + std::string(name.substr(5)) + ": " + bot->process().error();
+		}
+		return bot->process().running() ? std::move(bot) : nullptr;
+	}
+	if (name.find('/') == std::string_view::npos && name.find(".so") == std::string_view::npos) {
+		std::unique_ptr<Bot> bot = make_builtin_bot(name, seed, search_nodes);
+		if (!bot && error) {
+			*error = "unknown bot " + std::string(name);
+		}
+		return bot;
+	}
+	auto plugin = std::make_unique<PluginBot>(std::string(name), seed);
+	if (!plugin->loaded()) {
+		if (error) {
+			*error = plugin->error();
+		}
+		return nullptr;
+	}
+	return plugin;
+}
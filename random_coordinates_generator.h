@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+
+#include "types.h"
+
+/*
+ * 		Pcg32
+ *
+ * PCG-XSH-RR generator: 8 bytes of state where mt19937 carries 2.5 KB, which
+ * matters with thousands of games hosted at once. Plugs into the standard
+ * distributions. The LCG step is invertible, so the generator can also be
+ * walked back over numbers it already handed out.
+ */
+class Pcg32 {
+public:
+	using result_type = std::uint32_t;
+
+	explicit Pcg32(std::uint64_t seed = 0) noexcept {
+		this->seed(seed);
+	}
+
+	void seed(std::uint64_t seed) noexcept {
+		_state = 0;
+		step();
+		_state += seed;
+		step();
+	}
+
+	static constexpr result_type min() noexcept {
+		return 0;
+	}
+
+	static constexpr result_type max() noexcept {
+		return UINT32_MAX;
+	}
+
+	result_type operator()() noexcept {
+		std::uint64_t state = _state;
+		step();
+		_draws++;
+		auto xorshifted = static_cast<std::uint32_t>(((state >> 18) ^ state) >> 27);
+		auto rotation = static_cast<std::uint32_t>(state >> 59);
+		return (xorshifted >> rotation) | (xorshifted << ((32 - rotation) & 31));
+	}
+
+	// Numbers handed out so far
+	std::uint64_t draws() const noexcept {
+		return _draws;
+	}
+
+	// Undo the last `count` draws
+	void backtrack(std::uint64_t count) noexcept {
+		_draws -= count;
+		for (; count != 0; --count) {
+			_state = (_state - increment) * inverse_multiplier;
+		}
+	}
+
+	std::uint64_t state() const noexcept {
+		return _state;
+	}
+
+	// Continue from a saved state() and draws() (checkpoints)
+	void restore(std::uint64_t state, std::uint64_t draws) noexcept {
+		_state = state;
+		_draws = draws;
+	}
+
+private:
+	void step() noexcept {
+		_state = _state * multiplier + increment;
+	}
+
+	static constexpr std::uint64_t multiplier{6364136223846793005ULL};
+	static constexpr std::uint64_t inverse_multiplier{13877824140714322085ULL};	// multiplier * this == 1 mod 2^64
+	static constexpr std::uint64_t increment{1442695040888963407ULL};
+
+	std::uint64_t _state;
+	std::uint64_t _draws{0};
+};
+
+/*
+ * 		RandomCoordinatesGenerator
+ */
+class RandomCoordinatesGenerator {
+public:
+	RandomCoordinatesGenerator(unsigned short width, unsigned short height) noexcept :
+		RandomCoordinatesGenerator(width, height, std::random_device{}()) {}
+
+	// Fixed seed gives the same food sequence on every run (benchmarks, golden frames)
+	RandomCoordinatesGenerator(unsigned short width, unsigned short height, unsigned int seed) noexcept :
+		_random_generator(seed), _w_distribution(1, width - 1), _h_distribution(1, height - 1) {}
+
+	void seed(unsigned int seed) noexcept {
+		_random_generator.seed(seed);
+		_w_distribution.reset();
+		_h_distribution.reset();
+	}
+
+	std::uint64_t draws() const noexcept {
+		return _random_generator.draws();
+	}
+
+	// Take back the last `count` random numbers, e.g. to undo a food placement
+	void backtrack(std::uint64_t count) noexcept {
+		_random_generator.backtrack(count);
+	}
+
+	std::uint64_t state() const noexcept {
+		return _random_generator.state();
+	}
+
+	void restore(std::uint64_t state, std::uint64_t draws) noexcept {
+		_random_generator.restore(state, draws);
+		_w_distribution.reset();
+		_h_distribution.reset();
+	}
+
+	coordinates get() noexcept {
+		return {
+			_w_distribution(_random_generator),
+			_h_distribution(_random_generator)
+		};
+	};
+private:
+	Pcg32 _random_generator;
+	std::uniform_int_distribution<unsigned short> _w_distribution;
+	std::uniform_int_distribution<unsigned short> _h_distribution;
+};
@@ -0,0 +1,278 @@
+#pragma once
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "metrics.h"
+#include "session.h"
+#include "server_stats.h"
+
+/*
+ * 		ReactorCounters
+ *
+ * Per-reactor gauges, labeled by reactor in the metrics. Written only by the
+ * owning thread and aligned to a cache line so reactors never share one.
+ */
+struct alignas(64) ReactorCounters {
+	std::atomic<std::uint64_t> sessions{0};
+	std::atomic<std::uint64_t> sessions_idle{0};
+	std::atomic<std::uint64_t> sessions_recycled{0};
+	std::atomic<std::uint64_t> session_bytes{0};	// active and pooled sessions
+	std::atomic<std::uint64_t> busy_ns_total{0};
+};
+
+/*
+ * 		Reactor
+ *
+ * One thread with its own epoll set and sessions. New connections are
+ * handed over through adopt(); ticks are scheduled with a timerfd armed for
+ * the earliest session deadline. Sessions of players who left are kept in
+ * an idle pool and handed to the next connection, so once warmed up,
+ * accepting a player allocates nothing.
+ */
+class Reactor {
+public:
+	using clock = Session::clock;
+
+	// Idle sessions kept for reuse; beyond this they are freed
+	static constexpr size_t max_idle_sessions{256};
+
+	Reactor(unsigned short width, unsigned short height, unsigned int seed, ServerStats& stats) :
+		_width{width}, _height{height}, _seed{seed}, _stats{stats},
+		_epoll{epoll_create1(EPOLL_CLOEXEC)},
+		_wake{eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)},
+		_timer{timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)}
+	{
+		watch(_wake, EPOLLIN);
+		watch(_timer, EPOLLIN);
+		_thread = std::thread([this] { run(); });
+	}
+
+	~Reactor() {
+		_stopping.store(true);
+		signal();
+		_thread.join();
+		_active.clear();
+		_sessions.clear();
+		_idle.clear();
+		for (int fd : _incoming) {
+			close(fd);
+		}
+		close(_timer);
+		close(_wake);
+		close(_epoll);
+	}
+
+	Reactor(const Reactor&) = delete;
+	Reactor& operator=(const Reactor&) = delete;
+
+	// Thread-safe: hands a connected socket over to this reactor
+	void adopt(int fd) {
+		{
+			std::lock_guard<std::mutex> lock(_incoming_mutex);
+			_incoming.push_back(fd);
+		}
+		signal();
+	}
+
+	const ReactorCounters& counters() const noexcept {
+		return _counters;
+	}
+
+private:
+	void run() {
+		std::array<epoll_event, 64> events;
+		while (!_stopping.load(std::memory_order_relaxed)) {
+			arm_timer();
+			int ready = epoll_wait(_epoll, events.data(), events.size(), -1);
+			auto busy_since = clock::now();
+			for (int i = 0; i < ready; ++i) {
+				int fd = events[i].data.fd;
+				if (fd == _wake) {
+					std::uint64_t value;
+					read(_wake, &value, sizeof(value));
+					adopt_incoming(busy_since);
+				} else if (fd == _timer) {
+					std::uint64_t expirations;
+					read(_timer, &expirations, sizeof(expirations));
+				} else {
+					handle_io(fd, events[i].events, busy_since);
+				}
+			}
+			run_due_ticks(clock::now());
+			bump(_counters.busy_ns_total,
+			     std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - busy_since).count());
+		}
+	}
+
+	void adopt_incoming(clock::time_point now) {
+		// Swapping two members back and forth keeps both capacities
+		{
+			std::lock_guard<std::mutex> lock(_incoming_mutex);
+			_adopting.swap(_incoming);
+		}
+		for (int fd : _adopting) {
+			if (static_cast<size_t>(fd) >= _sessions.size()) {
+				_sessions.resize(fd + 1);
+				_writing.resize(fd + 1);
+			}
+			if (_idle.empty()) {
+				_sessions[fd] = std::make_unique<Session>(fd, _width, _height, _seed++, now);
+			} else {
+				_sessions[fd] = std::move(_idle.back());
+				_idle.pop_back();
+				_sessions[fd]->reconnect(fd, _seed++, now);
+				bump(_counters.sessions_idle, -1);
+				bump(_counters.sessions_recycled, 1);
+			}
+			_active.push_back(_sessions[fd].get());
+			watch(fd, EPOLLIN | EPOLLOUT);
+			_writing[fd] = true;
+			bump(_counters.sessions, 1);
+			_stats.sessions_total.add();
+		}
+		_adopting.clear();
+		count_session_bytes();
+	}
+
+	void handle_io(int fd, std::uint32_t events, clock::time_point now) {
+		if (static_cast<size_t>(fd) >= _sessions.size() || !_sessions[fd]) {
+			return;
+		}
+		Session& session = *_sessions[fd];
+		bool alive = !(events & (EPOLLERR | EPOLLHUP));
+		if (alive && (events & EPOLLIN)) {
+			char buffer[256];
+			ssize_t size = read(fd, buffer, sizeof(buffer));
+			alive = size > 0 && session.on_input(buffer, size, now);
+		}
+		if (alive && (events & EPOLLOUT)) {
+			alive = send(session);
+		}
+		if (!alive) {
+			drop(fd);
+		}
+	}
+
+	void run_due_ticks(clock::time_point now) {
+		std::vector<int>& dead = _dead;
+		dead.clear();
+		for (Session* session : _active) {
+			if (session->next_tick() <= now) {
+				session->update(now, _stats);
+				if (!send(*session)) {
+					dead.push_back(session->fd());
+				}
+			}
+		}
+		for (int fd : dead) {
+			drop(fd);
+		}
+	}
+
+	// Flushes and watches for writability only while output is pending
+	bool send(Session& session) {
+		ssize_t sent = session.flush();
+		if (sent < 0) {
+			return false;
+		}
+		_stats.bytes_out_total.add(sent);
+		bool writing = session.has_pending_output();
+		char& watching = _writing[session.fd()];
+		if (writing != watching) {
+			epoll_event event{};
+			event.events = EPOLLIN | (writing ? static_cast<std::uint32_t>(EPOLLOUT) : 0u);
+			event.data.fd = session.fd();
+			epoll_ctl(_epoll, EPOLL_CTL_MOD, session.fd(), &event);
+			watching = writing;
+		}
+		return true;
+	}
+
+	void drop(int fd) {
+		std::unique_ptr<Session> session = std::move(_sessions[fd]);
+		_active.erase(std::find(_active.begin(), _active.end(), session.get()));
+		// Closing the socket also removes it from the epoll set
+		session->disconnect();
+		if (_idle.size() < max_idle_sessions) {
+			_idle.push_back(std::move(session));
+			bump(_counters.sessions_idle, 1);
+		}
+		bump(_counters.sessions, -1);	// unsigned wrap-around: a decrement
+		count_session_bytes();
+	}
+
+	// Refreshed as sessions come and go; output buffers grow a little in between
+	void count_session_bytes() noexcept {
+		std::uint64_t bytes = 0;
+		for (const Session* session : _active) {
+			bytes += session->memory_bytes();
+		}
+		for (const auto& session : _idle) {
+			bytes += session->memory_bytes();
+		}
+		_counters.session_bytes.store(bytes, std::memory_order_relaxed);
+	}
+
+	void arm_timer() {
+		itimerspec spec{};
+		if (!_active.empty()) {
+			clock::time_point earliest = clock::time_point::max();
+			for (const Session* session : _active) {
+				earliest = std::min(earliest, session->next_tick());
+			}
+			// steady_clock is CLOCK_MONOTONIC, so its epoch works as an absolute timerfd deadline
+			auto deadline = std::chrono::duration_cast<std::chrono::nanoseconds>(earliest.time_since_epoch()).count();
+			spec.it_value.tv_sec = deadline / 1000000000;
+			spec.it_value.tv_nsec = std::max<long long>(deadline % 1000000000, 1);
+		}
+		timerfd_settime(_timer, TFD_TIMER_ABSTIME, &spec, nullptr);
+	}
+
+	// Single writer: plain load and store, no locked instruction
+	static void bump(std::atomic<std::uint64_t>& counter, std::uint64_t by) noexcept {
+		stats_add(counter, by, false);
+	}
+
+	void watch(int fd, std::uint32_t events) {
+		epoll_event event{};
+		event.events = events;
+		event.data.fd = fd;
+		epoll_ctl(_epoll, EPOLL_CTL_ADD, fd, &event);
+	}
+
+	void signal() {
+		std::uint64_t one = 1;
+		write(_wake, &one, sizeof(one));
+	}
+
+	unsigned short _width;
+	unsigned short _height;
+	unsigned int _seed;
+	ServerStats& _stats;
+	int _epoll;
+	int _wake;
+	int _timer;
+	ReactorCounters _counters;
+	std::vector<std::unique_ptr<Session>> _sessions;	// indexed by fd
+	std::vector<char> _writing;	// indexed by fd: EPOLLOUT is on
+	std::vector<Session*> _active;
+	std::vector<std::unique_ptr<Session>> _idle;
+	std::vector<int> _dead;
+	std::vector<int> _adopting;
+	std::mutex _incoming_mutex;
+	std::vector<int> _incoming;
+	std::atomic<bool> _stopping{false};
+	std::thread _thread;
+};
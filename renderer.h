@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string_view>
+
+#include "glyph_cache.h"
+
+/*
+ * 		Renderer
+ *
+ * Everything a screen draws goes through this interface, so the same
+ * Game/Menu/Info code can paint either the terminal or an in-memory grid.
+ * Method names avoid clear/refresh/box: ncurses defines those as macros.
+ */
+class Renderer {
+public:
+	virtual ~Renderer() = default;
+
+	virtual void clear_screen() noexcept = 0;
+	virtual void put(unsigned short y, unsigned short x, std::string_view text) noexcept = 0;
+	virtual void put_glyph(unsigned short y, unsigned short x, Glyph glyph) noexcept = 0;
+	virtual void highlight(bool on) noexcept = 0;
+	virtual void draw_border() noexcept = 0;
+	virtual void present() noexcept = 0;
+};
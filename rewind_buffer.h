@@ -0,0 +1,70 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "types.h"
+
+/*
+ * 		TickDelta
+ *
+ * Everything one tick changed, enough to undo it: the tail cell the body
+ * dropped (unless it grew), the food before the tick and how many random
+ * numbers placing the next one took, plus the state flags. 16 bytes.
+ */
+struct TickDelta {
+	coordinates tail;
+	coordinates food;
+	std::uint32_t draws;
+	unsigned char direction : 2;	// Direction before the tick
+	unsigned char status : 2;	// GameStatus before the tick
+	unsigned char grew : 1;		// the tail stayed: the snake had eaten the tick before
+	unsigned char ate : 1;
+	unsigned char sped_up : 1;
+};
+
+/*
+ * 		RewindBuffer
+ *
+ * Fixed-size ring of the latest tick deltas; the oldest are overwritten.
+ * Allocated once, so recording a tick costs a 16-byte store.
+ */
+class RewindBuffer {
+public:
+	explicit RewindBuffer(size_t capacity) : _deltas(std::max<size_t>(capacity, 1)) {}
+
+	void push(const TickDelta& delta) noexcept {
+		_deltas[_next] = delta;
+		_next = (_next + 1) % _deltas.size();
+		_size = std::min(_size + 1, _deltas.size());
+	}
+
+	// Takes back the latest delta; false when there is none
+	bool pop(TickDelta& delta) noexcept {
+		if (_size == 0) {
+			return false;
+		}
+		_next = (_next + _deltas.size() - 1) % _deltas.size();
+		_size--;
+		delta = _deltas[_next];
+		return true;
+	}
+
+	void clear() noexcept {
+		_size = 0;
+	}
+
+	size_t size() const noexcept {
+		return _size;
+	}
+
+	size_t capacity() const noexcept {
+		return _deltas.size();
+	}
+
+private:
+	std::vector<TickDelta> _deltas;
+	size_t _next{0};
+	size_t _size{0};
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string_view>
+
+#include "types.h"
+#include "renderer.h"
+
+/*
+ * 		Screen
+ */
+class Screen {
+public:
+	Screen(unsigned short & width, unsigned short & height, Renderer & renderer) :
+		_width{width}, _height{height}, _renderer{renderer} {}
+
+	virtual ~Screen() = default;
+
+	virtual void render() noexcept = 0;
+	virtual void input_handler(int, AppStatus&) noexcept = 0;
+
+	unsigned short get_width() const noexcept {
+		return _width;
+	}
+
+	unsigned short get_height() const noexcept {
+		return _height;
+	}
+
+protected:
+	Renderer & renderer() const noexcept {
+		return _renderer;
+	}
+
+	void clear_once() noexcept {
+		if (!_was_cleaned) {
+			_renderer.clear_screen();
+			_was_cleaned = true;
+		}
+	}
+
+	void on_leave() noexcept {
+		_was_cleaned = false;
+	}
+
+	void print_on_center(std::string_view msg) const noexcept {
+		_renderer.put(_height / 2, (_width / 2) - (msg.size() / 2), msg);
+	}
+
+private:
+	unsigned short & _width;
+	unsigned short & _height;
+	Renderer & _renderer;
+	bool _was_cleaned{false};
+};
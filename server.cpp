@@ -0,0 +1,169 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "metrics.h"
+#include "reactor.h"
+#include "server_stats.h"
+
+namespace {
+
+struct ServerOptions {
+	unsigned short port{5555};
+	unsigned short metrics_port{9464};
+	unsigned int threads{std::max(std::thread::hardware_concurrency(), 1u)};
+	unsigned short width{80};
+	unsigned short height{24};
+};
+
+ServerOptions parse_options(int argc, char** argv) {
+	ServerOptions options;
+	for (int i = 1; i < argc; ++i) {
+		if (i + 1 < argc && !std::strcmp(argv[i], "--port")) {
+			options.port = std::atoi(argv[++i]);
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--metrics-port")) {
+			options.metrics_port = std::atoi(argv[++i]);
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--threads")) {
+			options.threads = std::max(1, std::atoi(argv[++i]));
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--board")) {
+			unsigned int width = 0, height = 0;
+			if (std::sscanf(argv[++i], "%ux%u", &width, &height) != 2 || width < 24 || height < 12) {
+				std::fprintf(stderr, "board must be WIDTHxHEIGHT, at least 24x12\n");
+				std::exit(1);
+			}
+			options.width = width;
+			options.height = height;
+		} else {
+			std::fprintf(stderr, "usage: %s [--port P] [--metrics-port P] [--threads N] [--board WxH]\n", argv[0]);
+			std::exit(1);
+		}
+	}
+	return options;
+}
+
+std::string render_metrics(const ServerStats& stats, const std::vector<std::unique_ptr<Reactor>>& reactors) {
+	std::uint64_t sessions = 0, idle = 0, recycled = 0, session_bytes = 0;
+	for (const auto& reactor : reactors) {
+		sessions += reactor->counters().sessions.load(std::memory_order_relaxed);
+		idle += reactor->counters().sessions_idle.load(std::memory_order_relaxed);
+		recycled += reactor->counters().sessions_recycled.load(std::memory_order_relaxed);
+		session_bytes += reactor->counters().session_bytes.load(std::memory_order_relaxed);
+	}
+
+	PrometheusText text;
+	text.header("snake_sessions_active", "gauge", "Players currently connected.");
+	text.sample("snake_sessions_active", sessions);
+	text.header("snake_sessions_total", "counter", "Sessions accepted since start.");
+	text.sample("snake_sessions_total", stats.sessions_total.read());
+	text.header("snake_sessions_idle", "gauge", "Sessions pooled for reuse by the next players.");
+	text.sample("snake_sessions_idle", idle);
+	text.header("snake_sessions_recycled_total", "counter", "Sessions handed out from the pool instead of allocated.");
+	text.sample("snake_sessions_recycled_total", recycled);
+	text.header("snake_session_memory_bytes", "gauge", "Memory held by active and pooled sessions.");
+	text.sample("snake_session_memory_bytes", session_bytes);
+	text.header("snake_session_bytes", "gauge", "Average memory per active or pooled session.");
+	text.sample("snake_session_bytes", sessions + idle ? session_bytes / (sessions + idle) : 0);
+	text.header("snake_ticks_total", "counter", "Game ticks run; rate() gives ticks per second.");
+	text.sample("snake_ticks_total", stats.ticks_total.read());
+	text.header("snake_tick_lateness_seconds", "histogram", "How late ticks ran after their deadline.");
+	text.histogram("snake_tick_lateness_seconds", stats.tick_lateness.read());
+	text.header("snake_output_bytes_total", "counter", "Bytes sent to players.");
+	text.sample("snake_output_bytes_total", stats.bytes_out_total.read());
+	text.header("snake_frames_dropped_total", "counter", "Frames skipped because a client could not keep up.");
+	text.sample("snake_frames_dropped_total", stats.frames_dropped.read());
+	text.header("snake_input_latency_seconds", "summary", "From a key arriving to the frame that shows it.");
+	text.summary("snake_input_latency_seconds", stats.input_latency.read());
+	text.header("snake_reactor_busy_seconds_total", "counter", "Time each reactor thread spent working; rate() is its core load.");
+	for (size_t i = 0; i < reactors.size(); ++i) {
+		text.sample("snake_reactor_busy_seconds_total",
+			    reactors[i]->counters().busy_ns_total.load(std::memory_order_relaxed) / 1e9,
+			    "reactor=\"" + std::to_string(i) + "\"");
+	}
+	text.header("snake_reactor_sessions", "gauge", "Players handled by each reactor thread.");
+	for (size_t i = 0; i < reactors.size(); ++i) {
+		text.sample("snake_reactor_sessions", reactors[i]->counters().sessions.load(std::memory_order_relaxed),
+			    "reactor=\"" + std::to_string(i) + "\"");
+	}
+	return text.str();
+}
+
+std::atomic<bool> stopping{false};
+
+void on_signal(int) {
+	stopping.store(true);
+}
+
+} // local namespace
+
+int main(int argc, char** argv) {
+	ServerOptions options = parse_options(argc, argv);
+
+	int listener = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	int reuse = 1;
+	setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+	sockaddr_in address{};
+	address.sin_family = AF_INET;
+	address.sin_port = htons(options.port);
+	address.sin_addr.s_addr = htonl(INADDR_ANY);
+	if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 128) != 0) {
+		std::perror("listen");
+		return 1;
+	}
+
+	auto stats = std::make_unique<ServerStats>();
+	std::vector<std::unique_ptr<Reactor>> reactors;
+	for (unsigned int i = 0; i < options.threads; ++i) {
+		reactors.push_back(std::make_unique<Reactor>(options.width, options.height, i * 1000000, *stats));
+	}
+	MetricsEndpoint metrics(options.metrics_port, [&stats, &reactors] { return render_metrics(*stats, reactors); });
+	if (!metrics.listening()) {
+		std::fprintf(stderr, "metrics endpoint could not listen on 127.0.0.1:%u\n", options.metrics_port);
+	}
+	std::printf("serving %ux%u boards on port %u, metrics on http://127.0.0.1:%u/metrics, %u reactor(s)\n",
+		    options.width, options.height, options.port, options.metrics_port, options.threads);
+	{
+		Session probe(-1, options.width, options.height, 0, Session::clock::now());
+		std::printf("%zu bytes per new session\n", probe.memory_bytes());
+	}
+	std::fflush(stdout);
+
+	// No SA_RESTART: a signal interrupts accept() so the loop can exit
+	struct sigaction action{};
+	action.sa_handler = on_signal;
+	sigaction(SIGINT, &action, nullptr);
+	sigaction(SIGTERM, &action, nullptr);
+
+	size_t next_reactor = 0;
+	while (!stopping.load()) {
+		int client = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (client < 0) {
+			if (errno == EINTR || errno == ECONNABORTED) {
+				continue;
+			}
+			if (errno == EMFILE || errno == ENFILE) {
+				// Out of descriptors: back off until sessions close
+				std::this_thread::sleep_for(std::chrono::milliseconds{10});
+				continue;
+			}
+			std::perror("accept");
+			break;
+		}
+		int nodelay = 1;
+		setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+		reactors[next_reactor++ % reactors.size()]->adopt(client);
+	}
+	close(listener);
+	return 0;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "stats.h"
+
+/*
+ * 		ServerStats
+ *
+ * Server-wide statistics. All reactor threads update the same object, each
+ * through its own per-thread slots; the metrics endpoint merges on read.
+ */
+struct ServerStats {
+	ShardedCounter sessions_total;
+	ShardedCounter ticks_total;
+	ShardedCounter bytes_out_total;
+	ShardedCounter frames_dropped;
+	ShardedHistogram tick_lateness;
+	ShardedHistogram input_latency;
+};
@@ -0,0 +1,229 @@
+#pragma once
+
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "framebuffer_renderer.h"
+#include "game.h"
+#include "server_stats.h"
+
+/*
+ * 		Session
+ *
+ * One player connected over a raw TCP (telnet) connection: a headless Game
+ * drawn into a framebuffer, keys parsed from the socket and frames sent as
+ * cell diffs. Owned and driven by exactly one reactor thread, which recycles
+ * it for the next player once this one leaves.
+ */
+class Session {
+public:
+	using clock = std::chrono::steady_clock;
+
+	// Unsent output beyond this means a slow client; frames are skipped until it drains
+	static constexpr size_t max_pending_output{64 * 1024};
+
+	Session(int fd, unsigned short width, unsigned short height, unsigned int seed, clock::time_point now) :
+		_fd{fd}, _width{width}, _height{height}, _framebuffer(width, height),
+		_game(_width, _height, _framebuffer, seed), _next_tick{now}
+	{
+		_framebuffer.set_measure(false);
+		greet();
+	}
+
+	~Session() {
+		disconnect();
+	}
+
+	Session(const Session&) = delete;
+	Session& operator=(const Session&) = delete;
+
+	int fd() const noexcept {
+		return _fd;
+	}
+
+	// Closes the connection but keeps the session around for reuse
+	void disconnect() noexcept {
+		if (_fd >= 0) {
+			close(_fd);
+			_fd = -1;
+		}
+	}
+
+	// Hands a disconnected session to a new player; reuses every buffer
+	void reconnect(int fd, unsigned int seed, clock::time_point now) noexcept {
+		_fd = fd;
+		_game.restart(seed);
+		_framebuffer.reset();
+		_next_tick = now;
+		_output.clear();
+		_sent = 0;
+		_parser = NORMAL;
+		_input_pending = false;
+		greet();
+	}
+
+	// Feeds bytes received from the client; returns false once the player quit
+	bool on_input(const char* data, size_t size, clock::time_point now) {
+		for (size_t i = 0; i < size; ++i) {
+			int key = parse(static_cast<unsigned char>(data[i]));
+			if (key == 0) {
+				continue;
+			}
+			if (!_input_pending) {
+				_input_pending = true;
+				_input_since = now;
+			}
+			AppStatus status{GAME};
+			_game.input_handler(key, status);
+			if (status != GAME) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	clock::time_point next_tick() const noexcept {
+		return _next_tick;
+	}
+
+	// Runs the tick that was due at next_tick() and queues the resulting frame
+	void update(clock::time_point now, ServerStats& stats) {
+		stats.tick_lateness.observe(std::chrono::duration_cast<std::chrono::microseconds>(now - _next_tick));
+		stats.ticks_total.add();
+		if (_game.status() == RUN) {
+			_game.tick();
+			_game.draw();
+		} else {
+			_game.render();
+		}
+		_framebuffer.draw_border();
+
+		auto interval = _game.tick_interval();
+		_next_tick += interval;
+		// Too far behind to catch up: skip the missed ticks instead of bursting
+		if (_next_tick < now) {
+			_next_tick = now + interval;
+		}
+
+		if (_output.size() - _sent > max_pending_output) {
+			stats.frames_dropped.add();
+			return;
+		}
+		// Not presenting a dropped frame keeps the diff relative to what the client last got
+		_framebuffer.encode(CELL_DIFF, _output);
+		_framebuffer.present();
+		if (_input_pending) {
+			stats.input_latency.observe(std::chrono::duration_cast<std::chrono::microseconds>(now - _input_since));
+			_input_pending = false;
+		}
+	}
+
+	// Sends as much pending output as the socket takes; returns bytes sent, -1 on error
+	ssize_t flush() noexcept {
+		size_t before = _sent;
+		while (_sent < _output.size()) {
+			ssize_t result = send(_fd, _output.data() + _sent, _output.size() - _sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+			if (result < 0) {
+				if (errno == EAGAIN || errno == EWOULDBLOCK) {
+					break;
+				}
+				return -1;
+			}
+			_sent += result;
+		}
+		ssize_t sent = _sent - before;
+		if (_sent == _output.size()) {
+			_output.clear();
+			_sent = 0;
+		}
+		return sent;
+	}
+
+	bool has_pending_output() const noexcept {
+		return _sent < _output.size();
+	}
+
+	// Everything this session keeps allocated: the object itself (game, snake
+	// and RNG live inline) plus framebuffer, snake body and output buffer
+	size_t memory_bytes() const noexcept {
+		return sizeof(Session) + _framebuffer.heap_bytes() + _game.heap_bytes() + _output.capacity();
+	}
+
+private:
+	enum ParserState {
+		NORMAL,
+		ESCAPE,
+		CSI,
+		TELNET_COMMAND,
+		TELNET_OPTION,
+		TELNET_SUBNEGOTIATION
+	};
+
+	void greet() noexcept {
+		// Telnet: we echo (i.e. nobody does) and go-ahead is suppressed, so the
+		// client sends every key right away. Then clear the screen and hide the cursor.
+		_output.append("\xff\xfb\x01\xff\xfb\x03\x1b[2J\x1b[?25l");
+	}
+
+	// Turns the byte stream into game keys; returns 0 while a sequence is incomplete
+	int parse(unsigned char byte) noexcept {
+		switch (_parser) {
+			case NORMAL:
+				if (byte == 0x1b) {
+					_parser = ESCAPE;
+				} else if (byte == 0xff) {
+					_parser = TELNET_COMMAND;
+				} else if (byte != '\r' && byte != '\n' && byte != 0) {
+					return byte;
+				}
+				return 0;
+			case ESCAPE:
+				_parser = (byte == '[' || byte == 'O') ? CSI : NORMAL;
+				return 0;
+			case CSI:
+				_parser = NORMAL;
+				switch (byte) {
+					case 'A':
+						return KEY_UP;
+					case 'B':
+						return KEY_DOWN;
+					case 'C':
+						return KEY_RIGHT;
+					case 'D':
+						return KEY_LEFT;
+					default:
+						return 0;
+				}
+			case TELNET_COMMAND:
+				// WILL/WONT/DO/DONT carry one option byte, SB runs until SE
+				_parser = (byte >= 251 && byte <= 254) ? TELNET_OPTION : (byte == 250 ? TELNET_SUBNEGOTIATION : NORMAL);
+				return 0;
+			case TELNET_OPTION:
+				_parser = NORMAL;
+				return 0;
+			case TELNET_SUBNEGOTIATION:
+				if (byte == 240) {
+					_parser = NORMAL;
+				}
+				return 0;
+			default:
+				_parser = NORMAL;
+				return 0;
+		}
+	}
+
+	int _fd;
+	unsigned short _width;
+	unsigned short _height;
+	FramebufferRenderer _framebuffer;
+	Game _game;
+	clock::time_point _next_tick;
+	std::string _output;
+	size_t _sent{0};	// bytes of _output already on the wire
+	ParserState _parser{NORMAL};
+	bool _input_pending{false};
+	clock::time_point _input_since;
+};
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+#include "types.h"
+#include "renderer.h"
+
+/*
+ * 		Snake
+ */
+class Snake {
+public:
+	// Room for `capacity` parts up front, so growing never reallocates mid-game
+	Snake(unsigned short init_x, unsigned short init_y, Direction direction, size_t capacity = 100) :
+		_direction{direction}
+	{
+		_body_parts.reserve(capacity);
+		_body_parts.emplace_back(init_x, init_y);
+	}
+
+	void setDirection(Direction direction) noexcept {
+		_direction = direction;
+	}
+
+	const Direction & getDirection() const {
+		return _direction;
+	}
+
+	// Back to a one-part snake; keeps the body's capacity, so it never allocates
+	void reset(unsigned short init_x, unsigned short init_y, Direction direction) noexcept {
+		_body_parts.resize(1);
+		_body_parts[0] = {init_x, init_y};
+		_direction = direction;
+		_will_be_grown = false;
+	}
+
+	// Replace the whole body, head first (solvers, replays); keeps the capacity when it fits
+	void assign(const coordinates* parts, size_t count, Direction direction, bool growing) {
+		_body_parts.assign(parts, parts + count);
+		_direction = direction;
+		_will_be_grown = growing;
+	}
+
+	void init(unsigned short init_x, unsigned short init_y) {
+		_body_parts.emplace_back(init_x, init_y);
+	}
+
+	// One step forward in the current direction
+	void advance() noexcept {
+		move_body();
+	}
+
+	void draw(Renderer& renderer) const noexcept {
+		std::for_each(_body_parts.begin() + 1, _body_parts.end(),
+			      [&renderer](const coordinates& part) {
+				      renderer.put_glyph(part.second, part.first, GLYPH_BODY);
+			      }
+		);
+		renderer.put_glyph(_body_parts[0].second, _body_parts[0].first, static_cast<Glyph>(GLYPH_HEAD_UP + _direction));
+	}
+
+	// Undo one advance(): the body steps back onto `tail`, or just shortens if it had grown
+	void retreat(coordinates tail, bool grew, Direction direction) noexcept {
+		std::move(_body_parts.begin() + 1, _body_parts.end(), _body_parts.begin());
+		if (grew) {
+			_body_parts.pop_back();
+		} else {
+			_body_parts.back() = tail;
+		}
+		_direction = direction;
+		_will_be_grown = grew;
+	}
+
+	const std::vector<coordinates> & body() const noexcept {
+		return _body_parts;
+	}
+
+	coordinates getHead() const noexcept {
+		return _body_parts[0];
+	};
+
+	void grow_up() noexcept {
+		_will_be_grown = true;
+	}
+
+	// Ate on the last tick: the tail stays put on the next one
+	bool growing() const noexcept {
+		return _will_be_grown;
+	}
+
+	bool is_part_of_body(const coordinates& coords) const {
+		return std::any_of(_body_parts.cbegin(), _body_parts.cend(),
+				   [&coords](const coordinates& part) {
+					   return part == coords;
+				   }
+		);
+	}
+
+	bool check_self_abuse() const {
+		return std::any_of(_body_parts.cbegin() + 1, _body_parts.cend(),
+				   [this](const coordinates& part) {
+					   return part == _body_parts.front();
+				   }
+		);
+	}
+
+private:
+	void move_body() {
+		coordinates last;
+		if (_will_be_grown) {
+			last = _body_parts.back();
+		}
+		for (auto it = _body_parts.rbegin(), end = _body_parts.rend() - 1; it != end; ++it) {
+			*it = *(it + 1);
+		}
+		if (_will_be_grown) {
+			_body_parts.emplace_back(last);
+			_will_be_grown = false;
+		}
+		_body_parts[0] = next_cell(_body_parts[0], _direction);
+	}
+
+	bool _will_be_grown{false};
+	std::vector<coordinates> _body_parts;
+	Direction _direction;
+};
@@ -0,0 +1,66 @@
+#ifndef SNAKE_BOT_API_H
+#define SNAKE_BOT_API_H
+
+/*
+ * 		Snake bot plugin API
+ *
+ * Plain C ABI for bots built as shared objects and loaded with dlopen by
+ * SnakeBench (--bot path/to/bot.so) and the tournament runner. A plugin
+ * exports snake_bot_plugin(), which returns a static description of the
+ * bot. The engine calls next_move() once per tick with a read-only view of
+ * the board that points straight into the engine's own state: nothing is
+ * copied, and none of it may be kept past the call.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SNAKE_BOT_API_VERSION 1
+
+/* Same values as the engine's Direction */
+enum snake_direction {
+	SNAKE_UP = 0,
+	SNAKE_RIGHT = 1,
+	SNAKE_DOWN = 2,
+	SNAKE_LEFT = 3
+};
+
+struct snake_cell {
+	unsigned short x;
+	unsigned short y;
+};
+
+/* Cells with 0 < x < width and 0 < y < height are inside; the rest is wall */
+struct snake_board_view {
+	unsigned short width;
+	unsigned short height;
+	unsigned short score;
+	unsigned char direction;	/* current snake_direction */
+	unsigned char growing;		/* ate last tick: the tail stays put on the next one */
+	struct snake_cell food;
+	unsigned int length;
+	const struct snake_cell* body;	/* head first, length cells */
+};
+
+struct snake_bot_plugin {
+	unsigned int api_version;	/* SNAKE_BOT_API_VERSION */
+	const char* name;
+	/* One bot instance; may return NULL when the bot keeps no state */
+	void* (*create)(unsigned int seed);
+	void (*destroy)(void* bot);
+	/* Before the first move of every game; may be NULL */
+	void (*game_start)(void* bot);
+	/* A snake_direction; reversing or anything else keeps the current one */
+	int (*next_move)(void* bot, const struct snake_board_view* view);
+};
+
+/* The one symbol a plugin exports */
+const struct snake_bot_plugin* snake_bot_plugin(void);
+typedef const struct snake_bot_plugin* (*snake_bot_plugin_entry)(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,197 @@
+#include <ncurses.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+#include "allocation_counter.h"
+#include "bot.h"
+#include "framebuffer_renderer.h"
+#include "game.h"
+#include "ncurses_renderer.h"
+#include "tick_timer.h"
+
+namespace {
+
+struct SoakOptions {
+	std::chrono::seconds duration{std::chrono::hours{1}};
+	std::chrono::seconds report_every{std::chrono::minutes{1}};
+	unsigned short width{80};
+	unsigned short height{24};
+	unsigned int tick_rate{1000};	// ticks per second, 0 = as fast as possible
+	unsigned int seed{42};
+	bool tty{false};
+	const char* log_path{nullptr};
+};
+
+// "90s", "30m", "2h" or plain seconds
+std::chrono::seconds parse_duration(const char* text) {
+	char* unit = nullptr;
+	long value = std::strtol(text, &unit, 10);
+	switch (*unit) {
+		case 'h':
+			return std::chrono::hours{value};
+		case 'm':
+			return std::chrono::minutes{value};
+		default:
+			return std::chrono::seconds{value};
+	}
+}
+
+SoakOptions parse_options(int argc, char** argv) {
+	SoakOptions options;
+	for (int i = 1; i < argc; ++i) {
+		if (!std::strcmp(argv[i], "--tty")) {
+			options.tty = true;
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--duration")) {
+			options.duration = parse_duration(argv[++i]);
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--report-every")) {
+			options.report_every = std::max(parse_duration(argv[++i]), std::chrono::seconds{1});
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--rate")) {
+			options.tick_rate = std::strtoul(argv[++i], nullptr, 10);
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--seed")) {
+			options.seed = std::strtoul(argv[++i], nullptr, 10);
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--log")) {
+			options.log_path = argv[++i];
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--board")) {
+			unsigned int width = 0, height = 0;
+			if (std::sscanf(argv[++i], "%ux%u", &width, &height) != 2 || width < 24 || height < 12) {
+				std::fprintf(stderr, "board must be WIDTHxHEIGHT, at least 24x12\n");
+				std::exit(1);
+			}
+			options.width = width;
+			options.height = height;
+		} else {
+			std::fprintf(stderr, "usage: %s [--duration 2h] [--report-every 1m] [--rate TICKS_PER_SECOND]\n"
+					     "\t[--board WxH] [--seed S] [--tty] [--log FILE]\n", argv[0]);
+			std::exit(1);
+		}
+	}
+	return options;
+}
+
+// Resident set size from /proc, in bytes
+unsigned long resident_bytes() {
+	unsigned long pages_total = 0, pages_resident = 0;
+	if (std::FILE* statm = std::fopen("/proc/self/statm", "r")) {
+		if (std::fscanf(statm, "%lu %lu", &pages_total, &pages_resident) != 2) {
+			pages_resident = 0;
+		}
+		std::fclose(statm);
+	}
+	return pages_resident * sysconf(_SC_PAGESIZE);
+}
+
+} // local namespace
+
+int main(int argc, char** argv) {
+	SoakOptions options = parse_options(argc, argv);
+	std::FILE* log = options.log_path ? std::fopen(options.log_path, "a") : (options.tty ? stderr : stdout);
+	if (!log) {
+		std::perror(options.log_path);
+		return 1;
+	}
+
+	// Headless by default; --tty draws through ncurses, e.g. inside a pty
+	std::unique_ptr<Renderer> renderer;
+	unsigned short width = options.width;
+	unsigned short height = options.height;
+	if (options.tty) {
+		setlocale(LC_ALL, "");
+		initscr();
+		curs_set(0);
+		getmaxyx(stdscr, height, width);
+		renderer = std::make_unique<NcursesRenderer>();
+	} else {
+		renderer = std::make_unique<FramebufferRenderer>(width, height);
+	}
+
+	TickTimer timer;
+	if (options.tick_rate) {
+		timer.start(std::chrono::microseconds{1000000 / std::min(options.tick_rate, 1000000u)});
+	}
+
+	GreedyBot bot;
+	unsigned int seed = options.seed;
+	auto game = std::make_unique<Game>(width, height, *renderer, seed++);
+	bot.on_game_start();
+	unsigned long long ticks = 0, games = 1, period_ticks = 0;
+	auto started = std::chrono::steady_clock::now();
+	auto next_report = started + options.report_every;
+	auto period_started = started;
+	auto period_allocations = AllocationCounter::count();
+
+	std::fprintf(log, "soak: %ux%u board, %u ticks/s, %lld s, reporting every %lld s\n", width, height,
+		     options.tick_rate, static_cast<long long>(options.duration.count()),
+		     static_cast<long long>(options.report_every.count()));
+	std::fflush(log);
+	while (true) {
+		std::uint64_t due = 1;
+		if (options.tick_rate) {
+			pollfd timer_fd{timer.fd(), POLLIN, 0};
+			poll(&timer_fd, 1, -1);
+			due = timer.expirations();
+		}
+		for (; due != 0; --due) {
+			if (game->status() == GAME_OVER) {
+				game->restart(seed++);
+				bot.on_game_start();
+				games++;
+			}
+			game->turn(bot.next_move(*game));
+			game->tick();
+			ticks++;
+			period_ticks++;
+		}
+		game->draw();
+		renderer->draw_border();
+		renderer->present();
+
+		// The duration is checked on every wakeup; stopping between reports
+		// still writes a last line for the partial period
+		auto now = std::chrono::steady_clock::now();
+		bool finished = now - started >= options.duration;
+		if (now < next_report && !finished) {
+			continue;
+		}
+		std::chrono::duration<double> period = now - period_started;
+		TickTimer::Jitter lateness = timer.take_jitter();
+		auto allocations = AllocationCounter::count();
+		long long seconds = std::chrono::duration_cast<std::chrono::seconds>(now - started).count();
+		std::fprintf(log, "%02lld:%02lld:%02lld ticks %llu games %llu ticks/s %.0f rss %.1fMiB body-capacity %zu",
+			     seconds / 3600, seconds / 60 % 60, seconds % 60, ticks, games, period_ticks / period.count(),
+			     resident_bytes() / 1048576.0, game->snake().body().capacity());
+		if (AllocationCounter::available()) {
+			std::fprintf(log, " allocs +%llu", allocations - period_allocations);
+		}
+		if (options.tick_rate) {
+			std::fprintf(log, " lateness p50 %lldus p99 %lldus max %lldus",
+				     static_cast<long long>(lateness.percentile(0.5).count()),
+				     static_cast<long long>(lateness.percentile(0.99).count()),
+				     static_cast<long long>(lateness.max.count()));
+		}
+		std::fprintf(log, "\n");
+		std::fflush(log);
+
+		period_started = now;
+		period_ticks = 0;
+		period_allocations = allocations;
+		next_report += options.report_every;
+		if (finished) {
+			break;
+		}
+	}
+
+	if (options.tty) {
+		endwin();
+	}
+	if (log != stdout && log != stderr) {
+		std::fclose(log);
+	}
+	return 0;
+}
@@ -0,0 +1,586 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "game.h"
+#include "bot.h"
+#include "snake.h"
+#include "thread_pool.h"
+
+namespace {
+
+// Boards up to 7x7, i.e. a 6x6 playfield inside the border
+constexpr unsigned short max_side{7};
+constexpr size_t max_cells{(max_side - 1) * (max_side - 1)};
+
+struct SolveOptions {
+	unsigned short width{5};
+	unsigned short height{5};
+	unsigned int threads{std::thread::hardware_concurrency()};
+	size_t memory_mb{256};
+};
+
+SolveOptions parse_options(int argc, char** argv) {
+	SolveOptions options;
+	for (int i = 1; i < argc; ++i) {
+		if (i + 1 < argc && !std::strcmp(argv[i], "--threads")) {
+			options.threads = std::max(1, std::atoi(argv[++i]));
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--memory")) {
+			options.memory_mb = std::max(1, std::atoi(argv[++i]));
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--board")) {
+			unsigned int width = 0, height = 0;
+			if (std::sscanf(argv[++i], "%ux%u", &width, &height) != 2 || width < 3 || height < 3 ||
+			    width > max_side || height > max_side) {
+				std::fprintf(stderr, "board must be WIDTHxHEIGHT, from 3x3 to %ux%u\n", max_side, max_side);
+				std::exit(1);
+			}
+			options.width = width;
+			options.height = height;
+		} else {
+			std::fprintf(stderr, "usage: %s [--board WxH] [--threads N] [--memory MB]\n", argv[0]);
+			std::exit(1);
+		}
+	}
+	return options;
+}
+
+std::uint64_t mix(std::uint64_t value) noexcept {
+	value ^= value >> 33;
+	value *= 0xff51afd7ed558ccdULL;
+	value ^= value >> 33;
+	value *= 0xc4ceb9fe1a85ec53ULL;
+	return value ^ (value >> 33);
+}
+
+/*
+ * 		StateKey
+ *
+ * A position packed into 128 bits: head, length, direction, growing flag,
+ * food, then 2 bits per body segment (the direction from each part to the
+ * next one). That is 91 bits at most on a 6x6 playfield, which leaves the
+ * top byte free for the solved table to keep the value in.
+ */
+struct StateKey {
+	std::uint64_t lo{0};
+	std::uint64_t hi{0};
+
+	bool operator==(const StateKey& other) const noexcept {
+		return lo == other.lo && hi == other.hi;
+	}
+
+	bool operator<(const StateKey& other) const noexcept {
+		return hi != other.hi ? hi < other.hi : lo < other.lo;
+	}
+
+	void put(std::uint64_t value, unsigned int bits, unsigned int& position) noexcept {
+		if (position < 64) {
+			lo |= value << position;
+			if (position + bits > 64) {
+				hi |= value >> (64 - position);
+			}
+		} else {
+			hi |= value << (position - 64);
+		}
+		position += bits;
+	}
+
+	std::uint64_t get(unsigned int bits, unsigned int& position) const noexcept {
+		std::uint64_t value;
+		if (position < 64) {
+			value = lo >> position;
+			if (position + bits > 64) {
+				value |= hi << (64 - position);
+			}
+		} else {
+			value = hi >> (position - 64);
+		}
+		position += bits;
+		return value & ((1ull << bits) - 1);
+	}
+
+	std::uint64_t hash() const noexcept {
+		return mix(lo ^ mix(hi));
+	}
+};
+
+struct Position {
+	std::array<coordinates, max_cells> parts;	// head first
+	unsigned char length{1};
+	Direction direction{Right};
+	bool growing{false};
+	coordinates food;
+};
+
+/*
+ * 		Board
+ *
+ * Playfield geometry and its symmetries: the 8 of the square, or the 4
+ * that keep a rectangle's orientation. Keys are canonicalized to the
+ * smallest encoding over all of them, so mirrored and rotated positions
+ * share one table entry.
+ */
+class Board {
+public:
+	struct Symmetry {
+		bool swap;
+		bool flip_x;
+		bool flip_y;
+	};
+
+	Board(unsigned short width, unsigned short height) noexcept :
+		_width{width}, _height{height}, _columns(width - 1), _rows(height - 1)
+	{
+		for (int bits = 0; bits < 8; ++bits) {
+			Symmetry symmetry{(bits & 4) != 0, (bits & 1) != 0, (bits & 2) != 0};
+			if (!symmetry.swap || _columns == _rows) {
+				_symmetries[_symmetries_count++] = symmetry;
+			}
+		}
+	}
+
+	unsigned short width() const noexcept {
+		return _width;
+	}
+
+	unsigned short height() const noexcept {
+		return _height;
+	}
+
+	unsigned int cells() const noexcept {
+		return _columns * _rows;
+	}
+
+	unsigned int symmetries() const noexcept {
+		return _symmetries_count;
+	}
+
+	StateKey encode(const Position& position, const Symmetry& symmetry = {false, false, false}) const noexcept {
+		StateKey key;
+		unsigned int bit = 0;
+		coordinates head = map(symmetry, position.parts[0]);
+		coordinates food = map(symmetry, position.food);
+		key.put(head.first - 1, 3, bit);
+		key.put(head.second - 1, 3, bit);
+		key.put(position.length - 1, 6, bit);
+		key.put(map(symmetry, position.direction), 2, bit);
+		key.put(position.growing, 1, bit);
+		key.put(food.first - 1, 3, bit);
+		key.put(food.second - 1, 3, bit);
+		for (unsigned int i = 1; i < position.length; ++i) {
+			key.put(map(symmetry, step(position.parts[i - 1], position.parts[i])), 2, bit);
+		}
+		return key;
+	}
+
+	StateKey canonical(const Position& position) const noexcept {
+		StateKey best = encode(position, _symmetries[0]);
+		for (unsigned int i = 1; i < _symmetries_count; ++i) {
+			best = std::min(best, encode(position, _symmetries[i]));
+		}
+		return best;
+	}
+
+	void decode(const StateKey& key, Position& position) const noexcept {
+		unsigned int bit = 0;
+		position.parts[0].first = key.get(3, bit) + 1;
+		position.parts[0].second = key.get(3, bit) + 1;
+		position.length = key.get(6, bit) + 1;
+		position.direction = static_cast<Direction>(key.get(2, bit));
+		position.growing = key.get(1, bit);
+		position.food.first = key.get(3, bit) + 1;
+		position.food.second = key.get(3, bit) + 1;
+		for (unsigned int i = 1; i < position.length; ++i) {
+			position.parts[i] = next_cell(position.parts[i - 1], static_cast<Direction>(key.get(2, bit)));
+		}
+	}
+
+private:
+	// Direction of the step between two neighbouring cells
+	static Direction step(coordinates from, coordinates to) noexcept {
+		if (to.first != from.first) {
+			return to.first > from.first ? Right : Left;
+		}
+		return to.second > from.second ? Down : Up;
+	}
+
+	coordinates map(const Symmetry& symmetry, coordinates cell) const noexcept {
+		unsigned short x = cell.first - 1, y = cell.second - 1;
+		if (symmetry.swap) {
+			std::swap(x, y);
+		}
+		if (symmetry.flip_x) {
+			x = _columns - 1 - x;
+		}
+		if (symmetry.flip_y) {
+			y = _rows - 1 - y;
+		}
+		return {static_cast<unsigned short>(x + 1), static_cast<unsigned short>(y + 1)};
+	}
+
+	static Direction map(const Symmetry& symmetry, Direction direction) noexcept {
+		// Up/Down move along y, Right/Left along x
+		if (symmetry.swap) {
+			static constexpr Direction swapped[4]{Left, Down, Right, Up};
+			direction = swapped[direction];
+		}
+		if (symmetry.flip_x && (direction == Right || direction == Left)) {
+			direction = opposite(direction);
+		}
+		if (symmetry.flip_y && (direction == Up || direction == Down)) {
+			direction = opposite(direction);
+		}
+		return direction;
+	}
+
+	unsigned short _width;
+	unsigned short _height;
+	unsigned short _columns;
+	unsigned short _rows;
+	std::array<Symmetry, 8> _symmetries;
+	unsigned int _symmetries_count{0};
+};
+
+/*
+ * 		SolvedTable
+ *
+ * Fixed-size open-addressing table of solved positions, 16 bytes a slot:
+ * the key with the value in its spare top byte. Split into shards with a
+ * lock each so threads rarely contend. Once a shard is three quarters
+ * full it stops taking entries; those positions are just solved again.
+ */
+class SolvedTable {
+public:
+	explicit SolvedTable(size_t bytes) {
+		size_t slots = 1;
+		while (slots * 2 * sizeof(StateKey) * shards_count <= bytes) {
+			slots *= 2;
+		}
+		for (Shard& shard : _shards) {
+			shard.slots.resize(slots);
+		}
+	}
+
+	bool find(const StateKey& key, unsigned int& value) noexcept {
+		std::uint64_t hash = key.hash();
+		Shard& shard = _shards[hash >> (64 - shards_bits)];
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		size_t mask = shard.slots.size() - 1;
+		for (size_t index = hash & mask;; index = (index + 1) & mask) {
+			const StateKey& slot = shard.slots[index];
+			if (slot.hi == 0) {
+				return false;
+			}
+			if (slot.lo == key.lo && (slot.hi & key_mask) == key.hi) {
+				value = (slot.hi >> value_shift) - 1;
+				return true;
+			}
+		}
+	}
+
+	void insert(const StateKey& key, unsigned int value) noexcept {
+		std::uint64_t hash = key.hash();
+		Shard& shard = _shards[hash >> (64 - shards_bits)];
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		size_t mask = shard.slots.size() - 1;
+		if (shard.used * 4 >= shard.slots.size() * 3) {
+			return;
+		}
+		for (size_t index = hash & mask;; index = (index + 1) & mask) {
+			StateKey& slot = shard.slots[index];
+			if (slot.hi == 0) {
+				slot.lo = key.lo;
+				slot.hi = key.hi | static_cast<std::uint64_t>(value + 1) << value_shift;
+				shard.used++;
+				return;
+			}
+			if (slot.lo == key.lo && (slot.hi & key_mask) == key.hi) {
+				return;
+			}
+		}
+	}
+
+	size_t entries() noexcept {
+		size_t total = 0;
+		for (Shard& shard : _shards) {
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			total += shard.used;
+		}
+		return total;
+	}
+
+	size_t bytes() const noexcept {
+		return _shards.size() * (sizeof(Shard) + _shards[0].slots.size() * sizeof(StateKey));
+	}
+
+private:
+	static constexpr unsigned int shards_bits{6};
+	static constexpr size_t shards_count{1u << shards_bits};
+	static constexpr unsigned int value_shift{56};
+	static constexpr std::uint64_t key_mask{(1ull << value_shift) - 1};
+
+	struct alignas(64) Shard {
+		std::mutex mutex;
+		std::vector<StateKey> slots;
+		size_t used{0};
+	};
+
+	std::array<Shard, shards_count> _shards;
+};
+
+/*
+ * 		KeySet
+ *
+ * Positions already queued in one search. Slots are stamped with a
+ * generation, so starting the next search is O(1) and reuses the memory.
+ */
+class KeySet {
+public:
+	void reset() noexcept {
+		if (++_generation == 0) {
+			std::fill(_stamps.begin(), _stamps.end(), 0);
+			_generation = 1;
+		}
+		_used = 0;
+	}
+
+	// False when the key was already there
+	bool insert(const StateKey& key) {
+		if ((_used + 1) * 2 > _keys.size()) {
+			grow();
+		}
+		size_t mask = _keys.size() - 1;
+		size_t index = key.hash() & mask;
+		for (; _stamps[index] == _generation; index = (index + 1) & mask) {
+			if (_keys[index] == key) {
+				return false;
+			}
+		}
+		_keys[index] = key;
+		_stamps[index] = _generation;
+		_used++;
+		return true;
+	}
+
+	size_t bytes() const noexcept {
+		return _keys.capacity() * sizeof(StateKey) + _stamps.capacity() * sizeof(std::uint32_t);
+	}
+
+private:
+	void grow() {
+		std::vector<StateKey> keys;
+		for (size_t i = 0; i < _keys.size(); ++i) {
+			if (_stamps[i] == _generation) {
+				keys.push_back(_keys[i]);
+			}
+		}
+		_keys.assign(std::max<size_t>(_keys.size() * 2, 1024), StateKey{});
+		_stamps.assign(_keys.size(), 0);
+		_generation = 1;
+		_used = 0;
+		for (const StateKey& key : keys) {
+			insert(key);
+		}
+	}
+
+	std::vector<StateKey> _keys;
+	std::vector<std::uint32_t> _stamps;
+	std::uint32_t _generation{1};
+	size_t _used{0};
+};
+
+/*
+ * 		Solver
+ *
+ * Food is placed by an adversary, so the value of a position is the score
+ * the snake can guarantee from it. Between two meals the snake alone picks
+ * the path: a breadth-first search over everything it can reach finds each
+ * way to eat, and the value is the best of those, 1 + the worst placement
+ * of the next food. Length grows with every meal, so the recursion always
+ * ends. Moves go through Snake and Game::is_inside, i.e. the game's own
+ * rules: three directions (reversing is ignored), the tail frees its cell
+ * unless the snake just ate.
+ */
+class Solver {
+public:
+	Solver(const Board& board, SolvedTable& table) :
+		_board{board}, _table{table}, _snake{1, 1, Right, max_cells}, _levels(max_cells + 1) {}
+
+	// Value of a position right after its food was placed
+	unsigned int solve(const Position& entry, unsigned int depth = 0) {
+		StateKey key = _board.canonical(entry);
+		unsigned int best = 0;
+		if (_table.find(key, best)) {
+			return best;
+		}
+		// Food only goes on free cells and the snake grows one tick after each
+		// meal, so a snake that has not just eaten can take one more
+		unsigned int bound = _board.cells() - entry.length + (entry.growing ? 0 : 1);
+
+		Level& level = _levels[depth];
+		level.queue.clear();
+		level.visited.reset();
+		level.queue.push_back(_board.encode(entry));
+		level.visited.insert(level.queue.back());
+		Position position, next;
+		for (size_t i = 0; i < level.queue.size() && best < bound; ++i) {
+			_board.decode(level.queue[i], position);
+			for (Direction direction : all_directions) {
+				if (direction == opposite(position.direction)) {
+					continue;
+				}
+				_snake.assign(position.parts.data(), position.length, position.direction, position.growing);
+				_snake.setDirection(direction);
+				_snake.advance();
+				_expanded++;
+
+				// Same order as Game::tick: food first, then collisions
+				const auto& body = _snake.body();
+				std::copy(body.begin(), body.end(), next.parts.begin());
+				next.length = body.size();
+				next.direction = direction;
+				next.growing = _snake.growing();
+				next.food = position.food;
+				if (_snake.getHead() == position.food) {
+					next.growing = true;
+					best = std::max(best, 1 + guaranteed(next, depth + 1));
+					continue;
+				}
+				if (!Game::is_inside(_snake.getHead(), _board.width(), _board.height()) || _snake.check_self_abuse()) {
+					continue;
+				}
+				StateKey reached = _board.encode(next);
+				if (level.visited.insert(reached)) {
+					level.queue.push_back(reached);
+				}
+			}
+		}
+		_table.insert(key, best);
+		return best;
+	}
+
+	// Worst food placement for a snake that has just eaten (or is about to start)
+	unsigned int guaranteed(Position position, unsigned int depth = 0) {
+		unsigned int worst = max_cells;
+		bool placed = false;
+		for (unsigned short y = 1; y < _board.height() && worst != 0; ++y) {
+			for (unsigned short x = 1; x < _board.width() && worst != 0; ++x) {
+				coordinates cell{x, y};
+				if (std::find(position.parts.begin(), position.parts.begin() + position.length, cell) !=
+				    position.parts.begin() + position.length) {
+					continue;
+				}
+				position.food = cell;
+				worst = std::min(worst, solve(position, depth));
+				placed = true;
+			}
+		}
+		// A full board has nowhere left for food (the game itself would spin in generate_food)
+		return placed ? worst : 0;
+	}
+
+	std::uint64_t expanded() const noexcept {
+		return _expanded;
+	}
+
+	size_t bytes() const noexcept {
+		size_t total = 0;
+		for (const Level& level : _levels) {
+			total += level.queue.capacity() * sizeof(StateKey) + level.visited.bytes();
+		}
+		return total;
+	}
+
+private:
+	// Search buffers for each nesting depth, kept between searches
+	struct Level {
+		std::vector<StateKey> queue;
+		KeySet visited;
+	};
+
+	const Board& _board;
+	SolvedTable& _table;
+	Snake _snake;
+	std::vector<Level> _levels;
+	std::uint64_t _expanded{0};
+};
+
+} // local namespace
+
+int main(int argc, char** argv) {
+	SolveOptions options = parse_options(argc, argv);
+	Board board(options.width, options.height);
+	SolvedTable table(options.memory_mb << 20);
+	ThreadPool pool(options.threads);
+
+	// One start per length-1 snake up to symmetry; the first food is up to the adversary too
+	std::vector<Position> starts;
+	std::vector<StateKey> seen;
+	for (unsigned short y = 1; y < options.height; ++y) {
+		for (unsigned short x = 1; x < options.width; ++x) {
+			for (Direction direction : all_directions) {
+				Position start;
+				start.parts[0] = {x, y};
+				start.direction = direction;
+				start.food = start.parts[0];
+				StateKey key = board.canonical(start);
+				if (std::find(seen.begin(), seen.end(), key) == seen.end()) {
+					seen.push_back(key);
+					starts.push_back(start);
+				}
+			}
+		}
+	}
+
+	std::vector<unsigned int> values(starts.size());
+	std::vector<std::unique_ptr<Solver>> solvers;
+	std::mutex solvers_mutex;
+	std::atomic<std::uint64_t> expanded{0};
+	auto started = std::chrono::steady_clock::now();
+	pool.run(starts.size(), [&](size_t i) {
+		std::unique_ptr<Solver> solver;
+		{
+			std::lock_guard<std::mutex> lock(solvers_mutex);
+			if (solvers.empty()) {
+				solver = std::make_unique<Solver>(board, table);
+			} else {
+				solver = std::move(solvers.back());
+				solvers.pop_back();
+			}
+		}
+		std::uint64_t before = solver->expanded();
+		values[i] = solver->guaranteed(starts[i]);
+		expanded += solver->expanded() - before;
+		std::lock_guard<std::mutex> lock(solvers_mutex);
+		solvers.push_back(std::move(solver));
+	});
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+
+	static const char* direction_names[]{"up", "right", "down", "left"};
+	std::printf("board %ux%u (%u playable cells), %u symmetries, %u thread(s)\n",
+		    options.width, options.height, board.cells(), board.symmetries(), pool.size());
+	std::printf("guaranteed score against adversarial food, per start (up to symmetry):\n");
+	for (size_t i = 0; i < starts.size(); ++i) {
+		std::printf("  head %u,%u %-5s %u\n", starts[i].parts[0].first, starts[i].parts[0].second,
+			    direction_names[starts[i].direction], values[i]);
+	}
+	size_t scratch = 0;
+	for (const auto& solver : solvers) {
+		scratch += solver->bytes();
+	}
+	std::printf("best start %u, worst start %u\n", *std::max_element(values.begin(), values.end()),
+		    *std::min_element(values.begin(), values.end()));
+	std::printf("%llu states in %.3f s, %.0f states/s\n", static_cast<unsigned long long>(expanded.load()),
+		    elapsed.count(), expanded.load() / elapsed.count());
+	std::printf("table %zu entries in %.1f MiB, search buffers %.1f MiB\n", table.entries(),
+		    table.bytes() / 1048576.0, scratch / 1048576.0);
+	return 0;
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/*
+ * 		Per-thread statistics
+ *
+ * Counters and histograms updated from many threads at once. Every thread
+ * writes only its own slot, each slot on its own cache line, so updates are
+ * plain stores that never bounce lines between cores; readers merge all
+ * slots. Slots are handed out per thread for the life of the process: the
+ * first stats_max_threads - 1 threads get private ones, any further thread
+ * shares the last slot and pays for an atomic add.
+ */
+constexpr size_t stats_max_threads{64};
+constexpr size_t stats_shared_slot{stats_max_threads - 1};
+
+inline size_t stats_thread_slot() noexcept {
+	static std::atomic<size_t> next_slot{0};
+	thread_local size_t slot = std::min(next_slot.fetch_add(1, std::memory_order_relaxed), stats_shared_slot);
+	return slot;
+}
+
+inline void stats_add(std::atomic<std::uint64_t>& value, std::uint64_t by, bool shared) noexcept {
+	if (shared) {
+		value.fetch_add(by, std::memory_order_relaxed);
+	} else {
+		value.store(value.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+	}
+}
+
+/*
+ * 		LatencyHistogram
+ *
+ * Fixed-bucket latency histogram, the building block of ShardedHistogram.
+ */
+class LatencyHistogram {
+public:
+	// Upper bounds in microseconds; the last bucket is +Inf
+	static constexpr std::array<std::uint64_t, 12> bounds_us{ {50, 100, 250, 500, 1000, 2500, 5000,
+								   10000, 25000, 50000, 100000, 250000} };
+	static constexpr size_t buckets_count{bounds_us.size() + 1};
+
+	struct Snapshot {
+		std::array<std::uint64_t, buckets_count> buckets{};
+		std::uint64_t count{0};
+		std::uint64_t sum_us{0};
+
+		void merge(const Snapshot& other) noexcept {
+			for (size_t i = 0; i < buckets_count; ++i) {
+				buckets[i] += other.buckets[i];
+			}
+			count += other.count;
+			sum_us += other.sum_us;
+		}
+
+		// Upper bound of the bucket holding the quantile, in seconds
+		double quantile(double q) const noexcept {
+			std::uint64_t rank = count * q, seen = 0;
+			for (size_t i = 0; i < bounds_us.size(); ++i) {
+				seen += buckets[i];
+				if (seen > rank) {
+					return bounds_us[i] / 1e6;
+				}
+			}
+			return count ? bounds_us.back() / 1e6 : 0;
+		}
+	};
+
+	// shared: more than one thread may write this histogram
+	void observe(std::chrono::microseconds latency, bool shared = false) noexcept {
+		std::uint64_t us = latency.count() > 0 ? latency.count() : 0;
+		size_t bucket = 0;
+		while (bucket < bounds_us.size() && us > bounds_us[bucket]) {
+			bucket++;
+		}
+		stats_add(_buckets[bucket], 1, shared);
+		stats_add(_count, 1, shared);
+		stats_add(_sum_us, us, shared);
+	}
+
+	Snapshot snapshot() const noexcept {
+		Snapshot snapshot;
+		for (size_t i = 0; i < buckets_count; ++i) {
+			snapshot.buckets[i] = _buckets[i].load(std::memory_order_relaxed);
+		}
+		snapshot.count = _count.load(std::memory_order_relaxed);
+		snapshot.sum_us = _sum_us.load(std::memory_order_relaxed);
+		return snapshot;
+	}
+
+private:
+	std::array<std::atomic<std::uint64_t>, buckets_count> _buckets{};
+	std::atomic<std::uint64_t> _count{0};
+	std::atomic<std::uint64_t> _sum_us{0};
+};
+
+/*
+ * 		ShardedCounter
+ */
+class ShardedCounter {
+public:
+	void add(std::uint64_t by = 1) noexcept {
+		size_t slot = stats_thread_slot();
+		stats_add(_shards[slot].value, by, slot == stats_shared_slot);
+	}
+
+	std::uint64_t read() const noexcept {
+		std::uint64_t total = 0;
+		for (const Shard& shard : _shards) {
+			total += shard.value.load(std::memory_order_relaxed);
+		}
+		return total;
+	}
+
+private:
+	struct alignas(64) Shard {
+		std::atomic<std::uint64_t> value{0};
+	};
+
+	std::array<Shard, stats_max_threads> _shards{};
+};
+
+/*
+ * 		ShardedHistogram
+ */
+class ShardedHistogram {
+public:
+	void observe(std::chrono::microseconds latency) noexcept {
+		size_t slot = stats_thread_slot();
+		_shards[slot].histogram.observe(latency, slot == stats_shared_slot);
+	}
+
+	LatencyHistogram::Snapshot read() const noexcept {
+		LatencyHistogram::Snapshot merged;
+		for (const Shard& shard : _shards) {
+			merged.merge(shard.histogram.snapshot());
+		}
+		return merged;
+	}
+
+private:
+	struct alignas(64) Shard {
+		LatencyHistogram histogram;
+	};
+
+	std::array<Shard, stats_max_threads> _shards{};
+};
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "types.h"
+#include "game.h"
+
+/*
+ * 		TailOracle
+ *
+ * Answers "can the head still reach the tail after this move?", the usual
+ * test for a move that does not box the snake in. The body is not a static
+ * wall: the cell of part i (head = 0) frees up after length - i ticks, one
+ * more while the snake is growing. A breadth-first search that lets the
+ * head enter a body cell once it has been vacated finds the tail as it
+ * moves away.
+ *
+ * Release times are kept as absolute ticks, so when the snake has simply
+ * advanced since the last query only the new head cell is written; a full
+ * O(length) pass is needed only around eating or a jump to another game.
+ * Search buffers are generation-stamped, so a query neither clears nor
+ * allocates after the first one on a board.
+ */
+class TailOracle {
+public:
+	bool tail_reachable_after(const Game& game, Direction direction) noexcept {
+		prepare(game);
+		const Snake& snake = game.snake();
+		if (direction == opposite(snake.getDirection())) {
+			direction = snake.getDirection();	// Game::turn ignores reversing
+		}
+		coordinates head = next_cell(snake.getHead(), direction);
+		if (!enterable(head, 1)) {
+			return false;
+		}
+		if (occupied(head) || (snake.body().size() == 1 && !snake.growing())) {
+			return true;
+		}
+
+		next_stamp();
+		size_t head_index = 0, tail_index = 0, level_end = 1;
+		std::uint64_t tick = 1;
+		_queue[tail_index++] = head;
+		_visited[index(head)] = _stamp;
+		while (head_index < tail_index) {
+			if (head_index == level_end) {
+				level_end = tail_index;
+				tick++;
+			}
+			coordinates cell = _queue[head_index++];
+			for (Direction step : all_steps) {
+				coordinates neighbour = next_cell(cell, step);
+				if (!enterable(neighbour, tick + 1) || _visited[index(neighbour)] == _stamp) {
+					continue;
+				}
+				// Stepping onto a cell the body has just left means following the tail
+				if (occupied(neighbour)) {
+					return true;
+				}
+				_visited[index(neighbour)] = _stamp;
+				_queue[tail_index++] = neighbour;
+			}
+		}
+		return false;
+	}
+
+	// Forces the next query to recompute every release time (benchmarks)
+	void invalidate() noexcept {
+		_length = 0;
+	}
+
+private:
+	static constexpr Direction all_steps[4]{Up, Right, Down, Left};
+
+	// Brings release times up to the snake's current position
+	void prepare(const Game& game) {
+		const Snake& snake = game.snake();
+		const auto& body = snake.body();
+		if (game.get_width() != _width || game.get_height() != _height) {
+			_width = game.get_width();
+			_height = game.get_height();
+			size_t cells = static_cast<size_t>(_width) * _height;
+			_release.assign(cells, 0);
+			_body.assign(cells, 0);
+			_visited.assign(cells, 0);
+			_queue.resize(cells);
+			_length = 0;
+		}
+		if (body.size() == _length && body.front() == _head && body.back() == _tail && snake.growing() == _growing) {
+			return;
+		}
+		// One step forward without growing: the old second-to-last part, due
+		// two ticks from then, is the new tail and only the head cell is new
+		bool advanced = _length > 1 && !_growing && !snake.growing() && body.size() == _length && body[1] == _head &&
+				_body[index(body.back())] == _body_stamp && _release[index(body.back())] == _now + 2;
+		if (advanced) {
+			_now++;
+			_release[index(body.front())] = _now + body.size();
+			_body[index(body.front())] = _body_stamp;
+		} else {
+			if (++_body_stamp == 0) {
+				std::fill(_body.begin(), _body.end(), 0);
+				_body_stamp = 1;
+			}
+			_now = 0;
+			for (size_t i = 0; i < body.size(); ++i) {
+				_release[index(body[i])] = body.size() - i + (snake.growing() ? 1 : 0);
+				_body[index(body[i])] = _body_stamp;
+			}
+		}
+		_length = body.size();
+		_head = body.front();
+		_tail = body.back();
+		_growing = snake.growing();
+	}
+
+	// Part of the body right now
+	bool occupied(coordinates cell) const noexcept {
+		size_t i = index(cell);
+		return _body[i] == _body_stamp && _release[i] > _now;
+	}
+
+	// On the board and free by `tick` moves from now
+	bool enterable(coordinates cell, std::uint64_t tick) const noexcept {
+		if (!Game::is_inside(cell, _width, _height)) {
+			return false;
+		}
+		size_t i = index(cell);
+		return _body[i] != _body_stamp || _release[i] <= _now + tick;
+	}
+
+	void next_stamp() noexcept {
+		if (++_stamp == 0) {
+			std::fill(_visited.begin(), _visited.end(), 0);
+			_stamp = 1;
+		}
+	}
+
+	size_t index(coordinates cell) const noexcept {
+		return static_cast<size_t>(cell.second) * _width + cell.first;
+	}
+
+	unsigned short _width{0};
+	unsigned short _height{0};
+	// Snake position the release times were last brought up to
+	size_t _length{0};
+	coordinates _head;
+	coordinates _tail;
+	bool _growing{false};
+	std::uint64_t _now{0};
+	std::vector<std::uint64_t> _release;	// absolute tick a body cell is vacated at
+	std::vector<std::uint32_t> _body;	// == _body_stamp for cells written since the last full pass
+	std::uint32_t _body_stamp{0};
+	std::vector<std::uint32_t> _visited;
+	std::uint32_t _stamp{0};
+	std::vector<coordinates> _queue;
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * 		ThreadPool
+ *
+ * Fork-join pool for data-parallel loops: run() hands out indices [0, count)
+ * to the workers and the calling thread, and returns when all are done.
+ */
+class ThreadPool {
+public:
+	// threads counts the caller too, so ThreadPool(1) runs everything inline
+	explicit ThreadPool(unsigned int threads = std::thread::hardware_concurrency()) {
+		for (unsigned int i = 1; i < std::max(threads, 1u); ++i) {
+			_workers.emplace_back([this] { work(); });
+		}
+	}
+
+	~ThreadPool() {
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stopping = true;
+		}
+		_wake.notify_all();
+		for (auto& worker : _workers) {
+			worker.join();
+		}
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	unsigned int size() const noexcept {
+		return _workers.size() + 1;
+	}
+
+	void run(size_t count, const std::function<void(size_t)>& job) {
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_job = &job;
+			_count = count;
+			_next.store(0, std::memory_order_relaxed);
+			_busy = _workers.size();
+			_generation++;
+		}
+		_wake.notify_all();
+		drain();
+
+		std::unique_lock<std::mutex> lock(_mutex);
+		_done.wait(lock, [this] { return _busy == 0; });
+		_job = nullptr;
+	}
+
+private:
+	void work() {
+		unsigned long seen = 0;
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+				_wake.wait(lock, [this, seen] { return _stopping || _generation != seen; });
+				if (_stopping) {
+					return;
+				}
+				seen = _generation;
+			}
+			drain();
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_busy--;
+			}
+			_done.notify_one();
+		}
+	}
+
+	void drain() {
+		for (size_t index; (index = _next.fetch_add(1, std::memory_order_relaxed)) < _count; ) {
+			(*_job)(index);
+		}
+	}
+
+	std::vector<std::thread> _workers;
+	std::mutex _mutex;
+	std::condition_variable _wake;
+	std::condition_variable _done;
+	const std::function<void(size_t)>* _job{nullptr};
+	size_t _count{0};
+	std::atomic<size_t> _next{0};
+	size_t _busy{0};
+	unsigned long _generation{0};
+	bool _stopping{false};
+};
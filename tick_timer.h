@@ -0,0 +1,112 @@
+#pragma once
+
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+/*
+ * 		TickTimer
+ *
+ * Periodic timerfd on CLOCK_MONOTONIC. The kernel keeps the deadlines, so
+ * ticks do not drift however late they are handled, and the fd can be
+ * waited on with poll() together with the keyboard. Each read records how
+ * late it came after the latest expiration (tick jitter).
+ */
+class TickTimer {
+public:
+	struct Jitter {
+		unsigned long long samples{0};
+		std::chrono::microseconds max{0};
+		// buckets[i] counts lateness in [2^(i-1), 2^i) microseconds
+		std::array<unsigned long long, 24> buckets{};
+
+		// Upper bound of the bucket holding the given fraction of samples
+		std::chrono::microseconds percentile(double fraction) const noexcept {
+			unsigned long long rank = samples * fraction, seen = 0;
+			for (size_t i = 0; i < buckets.size(); ++i) {
+				seen += buckets[i];
+				if (seen > rank) {
+					return std::min(max, std::chrono::microseconds{1LL << i});
+				}
+			}
+			return max;
+		}
+	};
+
+	TickTimer() noexcept : _fd{timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)} {}
+
+	~TickTimer() {
+		if (_fd >= 0) {
+			close(_fd);
+		}
+	}
+
+	TickTimer(const TickTimer&) = delete;
+	TickTimer& operator=(const TickTimer&) = delete;
+
+	void start(std::chrono::microseconds interval) noexcept {
+		_interval = interval;
+		set(interval, interval);
+	}
+
+	void stop() noexcept {
+		set(std::chrono::microseconds{0}, std::chrono::microseconds{0});
+	}
+
+	// Number of ticks due since the last call, without blocking
+	std::uint64_t expirations() noexcept {
+		std::uint64_t count = 0;
+		if (read(_fd, &count, sizeof(count)) != sizeof(count)) {
+			return 0;
+		}
+		itimerspec remaining{};
+		timerfd_gettime(_fd, &remaining);
+		auto until_next = std::chrono::seconds{remaining.it_value.tv_sec} +
+				  std::chrono::nanoseconds{remaining.it_value.tv_nsec};
+		record(std::chrono::duration_cast<std::chrono::microseconds>(_interval - until_next));
+		return count;
+	}
+
+	int fd() const noexcept {
+		return _fd;
+	}
+
+	const Jitter& jitter() const noexcept {
+		return _jitter;
+	}
+
+	// Jitter since the previous call, for reporting drift over time
+	Jitter take_jitter() noexcept {
+		Jitter taken = _jitter;
+		_jitter = Jitter{};
+		return taken;
+	}
+
+private:
+	void set(std::chrono::microseconds first, std::chrono::microseconds interval) noexcept {
+		itimerspec spec{};
+		spec.it_value.tv_sec = first.count() / 1000000;
+		spec.it_value.tv_nsec = (first.count() % 1000000) * 1000;
+		spec.it_interval.tv_sec = interval.count() / 1000000;
+		spec.it_interval.tv_nsec = (interval.count() % 1000000) * 1000;
+		timerfd_settime(_fd, 0, &spec, nullptr);
+	}
+
+	void record(std::chrono::microseconds lateness) noexcept {
+		lateness = std::max(lateness, std::chrono::microseconds{0});
+		size_t bucket = 0;
+		while (bucket + 1 < _jitter.buckets.size() && (1LL << bucket) <= lateness.count()) {
+			bucket++;
+		}
+		_jitter.buckets[bucket]++;
+		_jitter.samples++;
+		_jitter.max = std::max(_jitter.max, lateness);
+	}
+
+	int _fd;
+	std::chrono::microseconds _interval{0};
+	Jitter _jitter;
+};
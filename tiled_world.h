@@ -0,0 +1,114 @@
+#pragma once
+
+#include <unistd.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "framebuffer_renderer.h"
+#include "thread_pool.h"
+#include "game.h"
+#include "bot.h"
+#include "trace.h"
+#include "stats.h"
+
+/*
+ * 		TiledWorld
+ *
+ * A viewport filled with bot-played boards, meant for very large displays.
+ * Each step ticks and draws every board into its region of one shared
+ * framebuffer, spread over a thread pool; emit() then encodes the frame
+ * and hands it to the terminal with a single write.
+ */
+class TiledWorld {
+public:
+	TiledWorld(unsigned short width, unsigned short height, unsigned short tile_width, unsigned short tile_height,
+		   ThreadPool& pool, unsigned int seed) :
+		_framebuffer(width, height), _pool{pool}
+	{
+		_framebuffer.set_measure(false);
+		for (unsigned short top = 0; top + tile_height <= height; top += tile_height) {
+			for (unsigned short left = 0; left + tile_width <= width; left += tile_width) {
+				_tiles.push_back(std::make_unique<Tile>(_framebuffer, top, left, tile_width, tile_height, seed));
+				seed += 1000;
+			}
+		}
+		_step_job = [this](size_t index) { step(*_tiles[index], _ticks, _games); };
+	}
+
+	void step() {
+		TraceSpan span("compose");
+		_pool.run(_tiles.size(), _step_job);
+	}
+
+	// Returns the number of bytes written
+	size_t emit(int fd, OutputStrategy strategy) {
+		_output.clear();
+		_framebuffer.encode(strategy, _output);
+		_framebuffer.present();
+		size_t written = 0;
+		while (written < _output.size()) {
+			ssize_t result = ::write(fd, _output.data() + written, _output.size() - written);
+			if (result < 0) {
+				break;
+			}
+			written += result;
+		}
+		return written;
+	}
+
+	const FramebufferRenderer& framebuffer() const noexcept {
+		return _framebuffer;
+	}
+
+	size_t tiles() const noexcept {
+		return _tiles.size();
+	}
+
+	// Totals over all boards, updated from the pool threads without contention
+	std::uint64_t ticks() const noexcept {
+		return _ticks.read();
+	}
+
+	std::uint64_t games() const noexcept {
+		return _games.read();
+	}
+
+private:
+	struct Tile {
+		Tile(FramebufferRenderer& framebuffer, unsigned short top, unsigned short left,
+		     unsigned short width_, unsigned short height_, unsigned int seed_) :
+			width{width_}, height{height_}, region(framebuffer, top, left, width_, height_), seed{seed_}
+		{
+			game = std::make_unique<Game>(width, height, region, seed++);
+		}
+
+		unsigned short width;
+		unsigned short height;
+		FramebufferRegion region;
+		GreedyBot bot;
+		std::unique_ptr<Game> game;
+		unsigned int seed;
+	};
+
+	static void step(Tile& tile, ShardedCounter& ticks, ShardedCounter& games) noexcept {
+		if (tile.game->status() == GAME_OVER) {
+			tile.game->restart(tile.seed++);
+			tile.bot.on_game_start();
+			games.add();
+		}
+		ticks.add();
+		tile.game->turn(tile.bot.next_move(*tile.game));
+		tile.game->tick();
+		tile.game->draw();
+		tile.region.draw_border();
+	}
+
+	FramebufferRenderer _framebuffer;
+	ThreadPool& _pool;
+	std::vector<std::unique_ptr<Tile>> _tiles;
+	std::function<void(size_t)> _step_job;
+	ShardedCounter _ticks;
+	ShardedCounter _games;
+	std::string _output;
+};
@@ -0,0 +1,533 @@
+#include <sys/stat.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "framebuffer_renderer.h"
+#include "game.h"
+#include "bot.h"
+#include "plugin_bot.h"
+#include "external_bot.h"
+#include "thread_pool.h"
+
+namespace {
+
+constexpr char move_letters[4]{'U', 'R', 'D', 'L'};
+
+struct TournamentOptions {
+	std::vector<std::string> bots;
+	unsigned short width{40};
+	unsigned short height{20};
+	unsigned int games{100};
+	unsigned int seed{1};
+	unsigned int threads{std::thread::hardware_concurrency()};
+	unsigned long max_ticks{20000};
+	unsigned int lanes{16};
+	// Searching bots expand this many futures per move, so results do not
+	// depend on the machine; 0 gives them a share of each tick instead
+	unsigned int search_nodes{32};
+	// Games tick at this rate as far as bots can tell, which sets time-budgeted bots' thinking time
+	unsigned int turbo{1000};
+	unsigned int deadline_us{static_cast<unsigned int>(ExternalBotProcess::default_deadline.count())};
+	const char* replays{nullptr};
+	const char* replay{nullptr};
+};
+
+TournamentOptions parse_options(int argc, char** argv) {
+	TournamentOptions options;
+	for (int i = 1; i < argc; ++i) {
+		if (i + 1 < argc && !std::strcmp(argv[i], "--bot")) {
+			options.bots.emplace_back(argv[++i]);
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--games")) {
+			options.games = std::max(1, std::atoi(argv[++i]));
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--seed")) {
+			options.seed = std::strtoul(argv[++i], nullptr, 10);
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--threads")) {
+			options.threads = std::max(1, std::atoi(argv[++i]));
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--max-ticks")) {
+			options.max_ticks = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--search-nodes")) {
+			options.search_nodes = std::strtoul(argv[++i], nullptr, 10);
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--turbo")) {
+			options.turbo = std::strtoul(argv[++i], nullptr, 10);
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--lanes")) {
+			options.lanes = std::max(1, std::atoi(argv[++i]));
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--deadline-us")) {
+			options.deadline_us = std::strtoul(argv[++i], nullptr, 10);
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--replays")) {
+			options.replays = argv[++i];
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--replay")) {
+			options.replay = argv[++i];
+		} else if (i + 1 < argc && !std::strcmp(argv[i], "--board")) {
+			unsigned int width = 0, height = 0;
+			if (std::sscanf(argv[++i], "%ux%u", &width, &height) != 2 || width < 12 || height < 12) {
+				std::fprintf(stderr, "board must be WIDTHxHEIGHT, at least 12x12\n");
+				std::exit(1);
+			}
+			options.width = width;
+			options.height = height;
+		} else {
+			std::fprintf(stderr, "usage: %s --bot NAME [--bot NAME ...] [--games N] [--board WxH] [--seed S]\n"
+				     "\t[--threads N] [--max-ticks N] [--search-nodes N] [--turbo TICKS_PER_SECOND] [--lanes N]\n"
+				     "\t[--deadline-us US] [--replays DIR]\n"
+				     "\t%s --replay FILE\n", argv[0], argv[0]);
+			std::exit(1);
+		}
+	}
+	if (options.bots.empty() && !options.replay) {
+		options.bots = {builtin_bot_names.begin(), builtin_bot_names.end()};
+	}
+	return options;
+}
+
+bool is_external(const std::string& bot) noexcept {
+	return bot.compare(0, 5, "exec:") == 0;
+}
+
+/*
+ * 		GameRecord
+ *
+ * One game of one bot. Every bot plays game i on the same seed, so game i
+ * of two bots is a head-to-head on identical food.
+ */
+struct GameRecord {
+	unsigned int score{0};
+	unsigned long ticks{0};
+	double think_ns{0};
+	bool starved{false};	// stopped going nowhere: max ticks, or too long without food
+};
+
+// A game kept with its moves, for a replay file
+struct Replay {
+	size_t game{0};
+	unsigned int score{0};
+	std::string moves;
+};
+
+// Best and worst game a task played, the candidates for notable replays
+struct TaskReplays {
+	Replay best;
+	Replay worst;
+	bool any{false};
+
+	void offer(size_t game, unsigned int score, const std::string& moves) {
+		if (!any || score > best.score) {
+			best = {game, score, moves};
+		}
+		if (!any || score < worst.score) {
+			worst = {game, score, moves};
+		}
+		any = true;
+	}
+};
+
+/*
+ * 		Match
+ *
+ * Plays games [first, last) for one bot. In-process bots (built-in and
+ * plugins) play them one after the other; an external bot gets them all at
+ * once as lanes of one process, one batched round per tick.
+ */
+class Match {
+public:
+	Match(const TournamentOptions& options, std::vector<GameRecord>& records) :
+		_options(options), _records(records), _width(options.width), _height(options.height),
+		_starve_ticks(static_cast<unsigned long>(options.width) * options.height * 2), _unused(_width, _height) {}
+
+	void play(const std::string& bot_name, size_t first, size_t last) {
+		if (is_external(bot_name)) {
+			play_lanes(bot_name.substr(5), first, last);
+		} else {
+			play_in_process(bot_name, first, last);
+		}
+	}
+
+	const TaskReplays& replays() const noexcept {
+		return _replays;
+	}
+
+	unsigned long long late_rounds() const noexcept {
+		return _late_rounds;
+	}
+
+	// Why an external bot stopped partway; empty when it played to the end
+	const std::string& failure() const noexcept {
+		return _failure;
+	}
+
+private:
+	struct Lane {
+		std::unique_ptr<Game> game;
+		std::string moves;
+		unsigned long since_food{0};
+		unsigned int last_score{0};
+		bool done{false};
+	};
+
+	void play_in_process(const std::string& bot_name, size_t first, size_t last) {
+		std::unique_ptr<Bot> bot = make_bot(bot_name, _options.seed + first, nullptr,
+						    ExternalBotProcess::default_deadline, _options.search_nodes);
+		Lane lane;
+		lane.game = std::make_unique<Game>(_width, _height, _unused, _options.seed);
+		lane.moves.reserve(_options.max_ticks);
+		for (size_t game = first; game < last; ++game) {
+			start(lane, game);
+			bot->on_game_start();
+			std::chrono::steady_clock::duration thinking{0};
+			while (!lane.done) {
+				auto started = std::chrono::steady_clock::now();
+				Direction move = bot->next_move(*lane.game);
+				thinking += std::chrono::steady_clock::now() - started;
+				step(lane, move);
+			}
+			finish(lane, game, std::chrono::duration<double, std::nano>(thinking).count());
+		}
+	}
+
+	void play_lanes(const std::string& command, size_t first, size_t last) {
+		size_t count = last - first;
+		ExternalBotProcess bot(command, count, std::chrono::microseconds{_options.deadline_us});
+		std::vector<Lane> lanes(count);
+		std::vector<const Game*> views(count);
+		std::vector<Direction> moves(count);
+		std::vector<double> think_ns(count, 0.0);
+		for (size_t i = 0; i < count; ++i) {
+			lanes[i].game = std::make_unique<Game>(_width, _height, _unused, _options.seed);
+			start(lanes[i], first + i);
+			views[i] = lanes[i].game.get();
+		}
+		for (size_t playing = count; playing != 0;) {
+			auto started = std::chrono::steady_clock::now();
+			bot.next_moves(views.data(), count, moves.data());
+			std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - started;
+			double share = elapsed.count() / playing;
+			for (size_t i = 0; i < count; ++i) {
+				if (!views[i]) {
+					continue;
+				}
+				think_ns[i] += share;
+				step(lanes[i], moves[i]);
+				if (lanes[i].done) {
+					finish(lanes[i], first + i, think_ns[i]);
+					views[i] = nullptr;
+					playing--;
+				}
+			}
+		}
+		_late_rounds += bot.stats().timeouts;
+		if (!bot.running()) {
+			_failure = "exec:" + command + ": " + bot.error();
+		}
+	}
+
+	void start(Lane& lane, size_t game) {
+		lane.game->set_turbo(_options.turbo);
+		lane.game->restart(_options.seed + game);
+		lane.moves.clear();
+		lane.since_food = 0;
+		lane.last_score = 0;
+		lane.done = false;
+	}
+
+	void step(Lane& lane, Direction move) {
+		Game& game = *lane.game;
+		game.turn(move);
+		lane.moves.push_back(move_letters[game.snake().getDirection()]);
+		game.tick();
+		if (game.score() != lane.last_score) {
+			lane.last_score = game.score();
+			lane.since_food = 0;
+		}
+		lane.done = game.status() == GAME_OVER || lane.moves.size() >= _options.max_ticks ||
+			    ++lane.since_food > _starve_ticks;
+	}
+
+	void finish(const Lane& lane, size_t game, double think_ns) {
+		GameRecord& record = _records[game];
+		record.score = lane.game->score();
+		record.ticks = lane.moves.size();
+		record.think_ns = think_ns;
+		record.starved = lane.game->status() != GAME_OVER;
+		_replays.offer(game, record.score, lane.moves);
+	}
+
+	const TournamentOptions& _options;
+	std::vector<GameRecord>& _records;
+	unsigned short _width;
+	unsigned short _height;
+	unsigned long _starve_ticks;
+	// Games need a renderer, but a tournament never draws
+	FramebufferRenderer _unused;
+	TaskReplays _replays;
+	unsigned long long _late_rounds{0};
+	std::string _failure;
+};
+
+// Mean and half-width of its 95% confidence interval
+struct Estimate {
+	double mean{0};
+	double margin{0};
+};
+
+Estimate estimate(const std::vector<double>& samples) {
+	Estimate result;
+	if (samples.empty()) {
+		return result;
+	}
+	double sum = 0, squares = 0;
+	for (double sample : samples) {
+		sum += sample;
+	}
+	result.mean = sum / samples.size();
+	for (double sample : samples) {
+		squares += (sample - result.mean) * (sample - result.mean);
+	}
+	if (samples.size() > 1) {
+		result.margin = 1.96 * std::sqrt(squares / (samples.size() - 1) / samples.size());
+	}
+	return result;
+}
+
+bool write_replay(const std::string& path, const std::string& bot, const TournamentOptions& options, const Replay& replay,
+		  const GameRecord& record) {
+	std::ofstream out(path);
+	out << "# snake replay\n"
+	    << "bot " << bot << "\n"
+	    << "board " << options.width << "x" << options.height << "\n"
+	    << "seed " << options.seed + replay.game << "\n"
+	    << "score " << record.score << "\n"
+	    << "ticks " << record.ticks << "\n"
+	    << "moves " << replay.moves << "\n";
+	return static_cast<bool>(out);
+}
+
+// Replays a file written by --replays and checks it ends as recorded
+int check_replay(const char* path) {
+	std::ifstream in(path);
+	std::string line, key, bot, moves;
+	unsigned int width = 0, height = 0, seed = 0, score = 0;
+	unsigned long ticks = 0;
+	while (std::getline(in, line)) {
+		std::istringstream fields(line);
+		fields >> key;
+		if (key == "bot") {
+			std::getline(fields >> std::ws, bot);
+		} else if (key == "board") {
+			std::sscanf(line.c_str(), "board %ux%u", &width, &height);
+		} else if (key == "seed") {
+			fields >> seed;
+		} else if (key == "score") {
+			fields >> score;
+		} else if (key == "ticks") {
+			fields >> ticks;
+		} else if (key == "moves") {
+			fields >> moves;
+		}
+	}
+	if (width < 12 || height < 12) {
+		std::fprintf(stderr, "%s: not a replay\n", path);
+		return 1;
+	}
+	unsigned short board_width = width, board_height = height;
+	FramebufferRenderer framebuffer(board_width, board_height);
+	Game game(board_width, board_height, framebuffer, seed);
+	for (char letter : moves) {
+		auto found = static_cast<const char*>(std::memchr(move_letters, letter, sizeof(move_letters)));
+		if (!found || game.status() == GAME_OVER) {
+			break;
+		}
+		game.turn(static_cast<Direction>(found - move_letters));
+		game.tick();
+	}
+	game.draw();
+	framebuffer.draw_border();
+	std::fputs(framebuffer.to_string().c_str(), stdout);
+	bool matches = game.score() == score && moves.size() == ticks;
+	std::printf("%s on %ux%u, seed %u: score %u in %zu ticks, %s\n", bot.c_str(), width, height, seed, game.score(),
+		    moves.size(), matches ? "as recorded" : "DOES NOT MATCH the recorded score");
+	return matches ? 0 : 1;
+}
+
+} // local namespace
+
+int main(int argc, char** argv) {
+	TournamentOptions options = parse_options(argc, argv);
+	if (options.replay) {
+		return check_replay(options.replay);
+	}
+	for (const std::string& bot : options.bots) {
+		std::string error;
+		if (!make_bot(bot, 0, &error)) {
+			std::fprintf(stderr, "%s\n", error.c_str());
+			return 1;
+		}
+	}
+
+	// Work items: a chunk of games for one bot; an external bot plays a chunk as lanes of one process
+	struct Task {
+		size_t bot;
+		size_t first;
+		size_t last;
+	};
+	std::vector<Task> tasks;
+	for (size_t bot = 0; bot < options.bots.size(); ++bot) {
+		for (size_t first = 0; first < options.games; first += options.lanes) {
+			tasks.push_back({bot, first, std::min<size_t>(first + options.lanes, options.games)});
+		}
+	}
+	std::vector<std::vector<GameRecord>> records(options.bots.size(), std::vector<GameRecord>(options.games));
+	std::vector<TaskReplays> task_replays(tasks.size());
+	std::vector<unsigned long long> late_rounds(tasks.size());
+	std::vector<std::string> failures(tasks.size());
+
+	ThreadPool pool(options.threads);
+	auto started = std::chrono::steady_clock::now();
+	pool.run(tasks.size(), [&](size_t i) {
+		const Task& task = tasks[i];
+		Match match(options, records[task.bot]);
+		match.play(options.bots[task.bot], task.first, task.last);
+		task_replays[i] = match.replays();
+		late_rounds[i] = match.late_rounds();
+		failures[i] = match.failure();
+	});
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+	for (const std::string& failure : failures) {
+		if (!failure.empty()) {
+			std::fprintf(stderr, "%s\n", failure.c_str());
+			return 1;
+		}
+	}
+
+	size_t bots = options.bots.size();
+	std::printf("%zu bot(s) x %u games on %ux%u, seeds %u..%u, %u thread(s)\n\n", bots, options.games, options.width,
+		    options.height, options.seed, options.seed + options.games - 1, pool.size());
+
+	// Solo: ranked by mean score
+	std::vector<Estimate> solo(bots);
+	std::vector<size_t> order(bots);
+	unsigned long long total_ticks = 0;
+	for (size_t bot = 0; bot < bots; ++bot) {
+		std::vector<double> scores;
+		for (const GameRecord& record : records[bot]) {
+			scores.push_back(record.score);
+			total_ticks += record.ticks;
+		}
+		solo[bot] = estimate(scores);
+		order[bot] = bot;
+	}
+	std::sort(order.begin(), order.end(), [&solo](size_t a, size_t b) {
+		return solo[a].mean > solo[b].mean;
+	});
+	std::printf("solo      %-28s %16s %6s %6s %10s %8s %6s\n", "bot", "score (95% CI)", "min", "max", "us/move", "starved",
+		    "late");
+	for (size_t rank = 0; rank < bots; ++rank) {
+		size_t bot = order[rank];
+		unsigned int low = UINT32_MAX, high = 0, starved = 0;
+		double think_ns = 0;
+		unsigned long long ticks = 0, late = 0;
+		for (const GameRecord& record : records[bot]) {
+			low = std::min(low, record.score);
+			high = std::max(high, record.score);
+			starved += record.starved;
+			think_ns += record.think_ns;
+			ticks += record.ticks;
+		}
+		for (size_t i = 0; i < tasks.size(); ++i) {
+			late += tasks[i].bot == bot ? late_rounds[i] : 0;
+		}
+		std::printf("%4zu.     %-28.28s %8.1f +- %5.1f %6u %6u %10.2f %8u %6llu\n", rank + 1, options.bots[bot].c_str(),
+			    solo[bot].mean, solo[bot].margin, low, high, ticks ? think_ns / ticks / 1e3 : 0.0, starved, late);
+	}
+
+	// Versus: every pair compared game by game on the same seeds; a win is
+	// worth 1, a draw 0.5, ranked by points per match
+	if (bots > 1) {
+		std::vector<Estimate> points(bots);
+		std::vector<std::vector<double>> win_rate(bots, std::vector<double>(bots, 0.0));
+		for (size_t bot = 0; bot < bots; ++bot) {
+			std::vector<double> samples;
+			for (size_t other = 0; other < bots; ++other) {
+				if (other == bot) {
+					continue;
+				}
+				double total = 0;
+				for (size_t game = 0; game < options.games; ++game) {
+					unsigned int mine = records[bot][game].score, theirs = records[other][game].score;
+					double point = mine > theirs ? 1.0 : mine == theirs ? 0.5 : 0.0;
+					samples.push_back(point);
+					total += point;
+				}
+				win_rate[bot][other] = total / options.games;
+			}
+			points[bot] = estimate(samples);
+			order[bot] = bot;
+		}
+		std::sort(order.begin(), order.end(), [&points](size_t a, size_t b) {
+			return points[a].mean > points[b].mean;
+		});
+		std::printf("\nversus    %-28s %16s ", "bot", "points (95% CI)");
+		for (size_t column = 0; column < bots; ++column) {
+			std::printf(" vs%-3zu", column + 1);
+		}
+		std::printf("\n");
+		for (size_t rank = 0; rank < bots; ++rank) {
+			size_t bot = order[rank];
+			std::printf("%4zu.     %-28.28s %8.3f +- %5.3f ", rank + 1, options.bots[bot].c_str(), points[bot].mean,
+				    points[bot].margin);
+			for (size_t column = 0; column < bots; ++column) {
+				size_t other = order[column];
+				if (other == bot) {
+					std::printf("  %-4s", "-");
+				} else {
+					std::printf(" %4.0f%%", win_rate[bot][other] * 100);
+				}
+			}
+			std::printf("\n");
+		}
+	}
+
+	// Notable games: each bot's best and worst, as seed plus moves
+	if (options.replays) {
+		mkdir(options.replays, 0755);
+		for (size_t bot = 0; bot < bots; ++bot) {
+			const Replay* best = nullptr;
+			const Replay* worst = nullptr;
+			for (size_t i = 0; i < tasks.size(); ++i) {
+				const TaskReplays& candidates = task_replays[i];
+				if (tasks[i].bot != bot || !candidates.any) {
+					continue;
+				}
+				best = !best || candidates.best.score > best->score ? &candidates.best : best;
+				worst = !worst || candidates.worst.score < worst->score ? &candidates.worst : worst;
+			}
+			const Replay* notable[2] = {best, worst};
+			const char* kinds[2] = {"best", "worst"};
+			for (int kind = 0; kind < 2; ++kind) {
+				if (!notable[kind]) {
+					continue;
+				}
+				std::string path = std::string(options.replays) + "/bot" + std::to_string(bot + 1) + "-" + kinds[kind] + ".replay";
+				if (!write_replay(path, options.bots[bot], options, *notable[kind], records[bot][notable[kind]->game])) {
+					std::fprintf(stderr, "cannot write %s\n", path.c_str());
+					return 1;
+				}
+			}
+		}
+		std::printf("\nreplays of each bot's best and worst game in %s/ (check with --replay FILE)\n", options.replays);
+	}
+
+	size_t games = bots * options.games;
+	std::printf("\n%zu games, %llu ticks in %.2f s: %.0f games/s, %.0f ticks/s\n", games, total_ticks, elapsed.count(),
+		    games / elapsed.count(), total_ticks / elapsed.count());
+	return 0;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/*
+ * 		Trace
+ *
+ * Optional span recorder for finding stalls in a trace viewer
+ * (chrome://tracing, Perfetto). Each thread appends to its own fixed
+ * buffer without locks; write() dumps every buffer as Chrome trace-event
+ * JSON. When tracing is off a span costs one relaxed load.
+ */
+class Trace {
+public:
+	static void enable() noexcept {
+		_enabled.store(true, std::memory_order_relaxed);
+	}
+
+	static bool enabled() noexcept {
+		return _enabled.load(std::memory_order_relaxed);
+	}
+
+	static std::uint64_t now_ns() noexcept {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	// name must outlive the trace (a string literal)
+	static void record(const char* name, std::uint64_t begin_ns, std::uint64_t end_ns) noexcept {
+		thread_local Buffer* buffer = register_buffer();
+		size_t size = buffer->size.load(std::memory_order_relaxed);
+		if (size < buffer_capacity) {
+			buffer->events[size] = Event{name, begin_ns, end_ns - begin_ns};
+			buffer->size.store(size + 1, std::memory_order_release);
+		}
+	}
+
+	// Returns false if the file could not be written
+	static bool write(const char* path) {
+		std::FILE* file = std::fopen(path, "w");
+		if (!file) {
+			return false;
+		}
+		std::lock_guard<std::mutex> lock(_buffers_mutex);
+		std::fputs("{\"traceEvents\":[\n", file);
+		bool first = true;
+		for (size_t thread = 0; thread < _buffers.size(); ++thread) {
+			const Buffer& buffer = *_buffers[thread];
+			size_t size = buffer.size.load(std::memory_order_acquire);
+			for (size_t i = 0; i < size; ++i) {
+				const Event& event = buffer.events[i];
+				std::fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%zu,\"ts\":%.3f,\"dur\":%.3f}",
+					     first ? "" : ",\n", event.name, thread + 1, event.begin_ns / 1e3, event.duration_ns / 1e3);
+				first = false;
+			}
+		}
+		std::fputs("\n]}\n", file);
+		return std::fclose(file) == 0;
+	}
+
+private:
+	struct Event {
+		const char* name;
+		std::uint64_t begin_ns;
+		std::uint64_t duration_ns;
+	};
+
+	// About 24 MB per thread; spans past that are dropped
+	static constexpr size_t buffer_capacity{1 << 20};
+
+	struct Buffer {
+		std::atomic<size_t> size{0};
+		std::unique_ptr<Event[]> events{new Event[buffer_capacity]};
+	};
+
+	// Buffers are owned here, so spans of finished threads still get written
+	static Buffer* register_buffer() {
+		std::lock_guard<std::mutex> lock(_buffers_mutex);
+		_buffers.push_back(std::make_unique<Buffer>());
+		return _buffers.back().get();
+	}
+
+	static inline std::atomic<bool> _enabled{false};
+	static inline std::mutex _buffers_mutex;
+	static inline std::vector<std::unique_ptr<Buffer>> _buffers;
+};
+
+/*
+ * 		TraceSpan
+ */
+class TraceSpan {
+public:
+	explicit TraceSpan(const char* name) noexcept : _name{name}, _begin_ns{Trace::enabled() ? Trace::now_ns() : 0} {}
+
+	~TraceSpan() {
+		if (_begin_ns != 0) {
+			Trace::record(_name, _begin_ns, Trace::now_ns());
+		}
+	}
+
+	TraceSpan(const TraceSpan&) = delete;
+	TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+	const char* _name;
+	std::uint64_t _begin_ns;
+};
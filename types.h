@@ -0,0 +1,52 @@
+#pragma once
+
+#include <utility>
+
+enum AppStatus {
+	MENU,
+	GAME,
+	INFO,
+	ARENA,
+	EXIT
+};
+
+enum GameStatus {
+	RUN,
+	PAUSE,
+	GAME_OVER
+};
+
+// In this style 'cause ncurse already has function 'UP'
+enum Direction {
+	Up,
+	Right,
+	Down,
+	Left
+};
+
+typedef std::pair<unsigned short, unsigned short> coordinates;	// first = x; second = y;
+
+inline Direction opposite(Direction direction) noexcept {
+	return static_cast<Direction>((direction + 2) % 4);
+}
+
+// Cell the head lands on after one step in the given direction
+inline coordinates next_cell(coordinates cell, Direction direction) noexcept {
+	switch (direction) {
+		case Up:
+			cell.second--;
+			break;
+		case Right:
+			cell.first++;
+			break;
+		case Down:
+			cell.second++;
+			break;
+		case Left:
+			cell.first--;
+			break;
+		default:
+			break;
+	}
+	return cell;
+}